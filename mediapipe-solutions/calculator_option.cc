@@ -0,0 +1,334 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/calculator_option.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+
+using namespace std;
+using namespace google::protobuf;
+using namespace mediapipe;
+
+namespace {
+	// Where a "node.field" option lives for one calculator type.
+	struct ResolvedField {
+		const FieldDescriptor *extension;	// CalculatorOptions extension.
+		const Descriptor *options_type;
+		vector<const FieldDescriptor *> path;	// Nested fields, outermost first.
+	};
+
+	// Converts a number to a field's type, or throws std::range_error if that
+	// would change its value. Narrowing to float may round but must stay in
+	// range, as options are usually written as double literals.
+	template <typename T, typename S>
+	T ExactCast(S source) {
+		if constexpr (is_same_v<S, bool>)
+			return ExactCast<T>(int(source));
+		else if constexpr (is_same_v<T, bool>) {
+			if (source != S(0) and source != S(1))
+				throw range_error("Only 0 and 1 convert to bool.");
+
+			return source != S(0);
+		}
+		else if constexpr (is_floating_point_v<T> and is_floating_point_v<S>) {
+			if (isfinite(source) and (source < numeric_limits<T>::lowest() or source > numeric_limits<T>::max()))
+				throw range_error("The value is out of range.");
+
+			return T(source);
+		}
+		else if constexpr (is_floating_point_v<T>) {
+			using U = make_unsigned_t<S>;
+
+			// Exact if the magnitude fits the mantissa once trailing zero bits
+			// go into the exponent.
+			if constexpr (numeric_limits<U>::digits > numeric_limits<T>::digits) {
+				auto magnitude = source < 0 ? U(0) - U(source) : U(source);
+
+				while (magnitude >> numeric_limits<T>::digits and (magnitude & 1) == 0)
+					magnitude >>= 1;
+
+				if (magnitude >> numeric_limits<T>::digits)
+					throw range_error("The value has more digits than the field.");
+			}
+
+			return T(source);
+		}
+		else if constexpr (is_floating_point_v<S>) {
+			const auto bound = ldexp(1.0L, numeric_limits<T>::digits);
+
+			if (trunc(source) != source)
+				throw range_error("The value is not an integer.");
+			if (source >= bound or source < (is_signed_v<T> ? -bound : 0.0L))
+				throw range_error("The value is out of range.");
+
+			return T(source);
+		}
+		else {
+			if constexpr (is_signed_v<S>) {
+				if (source < 0) {
+					if (!is_signed_v<T> or intmax_t(source) < intmax_t(numeric_limits<T>::min()))
+						throw range_error("The value is out of range.");
+
+					return T(source);
+				}
+			}
+
+			if (uintmax_t(source) > uintmax_t(numeric_limits<T>::max()))
+				throw range_error("The value is out of range.");
+
+			return T(source);
+		}
+	}
+
+	template <typename T>
+	T NumericCast(const any &value) {
+		if (auto *v = any_cast<T>(&value))
+			return *v;
+		if (auto *v = any_cast<double>(&value))
+			return ExactCast<T>(*v);
+		if (auto *v = any_cast<float>(&value))
+			return ExactCast<T>(*v);
+		if (auto *v = any_cast<int>(&value))
+			return ExactCast<T>(*v);
+		if (auto *v = any_cast<int64_t>(&value))
+			return ExactCast<T>(*v);
+		if (auto *v = any_cast<unsigned>(&value))
+			return ExactCast<T>(*v);
+		if (auto *v = any_cast<uint64_t>(&value))
+			return ExactCast<T>(*v);
+		if (auto *v = any_cast<bool>(&value))
+			return ExactCast<T>(*v);
+
+		throw bad_any_cast();
+	}
+
+	int EnumNumber(const FieldDescriptor *field, const any &value) {
+		const auto number = NumericCast<int>(value);
+
+		if (!field->enum_type()->FindValueByNumber(number))
+			throw range_error("No value of " + field->enum_type()->full_name() + " has the number " + to_string(number) + ".");
+
+		return number;
+	}
+
+	const Descriptor *FindOptionsType(const CalculatorGraphConfig::Node &node) {
+		const auto *pool = DescriptorPool::generated_pool();
+
+		// MediaPipe names calculator options after the calculator.
+		if (const auto *type = pool->FindMessageTypeByName("mediapipe." + node.calculator() + "Options"))
+			return type;
+
+		for (const auto &nodeOptions : node.node_options()) {
+			const string typeName = nodeOptions.type_url().substr(nodeOptions.type_url().rfind('/') + 1);
+
+			if (const auto *type = pool->FindMessageTypeByName(typeName))
+				return type;
+		}
+
+		vector<const FieldDescriptor *> fields;
+		node.options().GetReflection()->ListFields(node.options(), &fields);
+
+		for (const auto *field : fields) {
+			if (field->is_extension() and field->message_type())
+				return field->message_type();
+		}
+
+		return nullptr;
+	}
+
+	ResolvedField Resolve(const CalculatorGraphConfig::Node &node, const string &fieldPath) {
+		static mutex cacheMutex;
+		static map<pair<string, string>, ResolvedField> cache;
+
+		const auto key = make_pair(node.calculator(), fieldPath);
+
+		{
+			lock_guard<mutex> lock(cacheMutex);
+
+			if (auto cached = cache.find(key); cached != cache.end())
+				return cached->second;
+		}
+
+		ResolvedField resolved {};
+
+		resolved.options_type = FindOptionsType(node);
+
+		if (!resolved.options_type)
+			throw out_of_range("No options type found for calculator " + node.calculator() + ".");
+
+		resolved.extension = DescriptorPool::generated_pool()->FindExtensionByName(
+			resolved.options_type->full_name() + ".ext");
+
+		const auto *type = resolved.options_type;
+
+		for (const auto &name : absl::StrSplit(fieldPath, '.')) {
+			const auto *field = type ? type->FindFieldByName(string(name)) : nullptr;
+
+			if (!field)
+				throw out_of_range("Field '" + fieldPath + "' not found in " + resolved.options_type->full_name() + ".");
+
+			resolved.path.push_back(field);
+			type = field->message_type();
+		}
+
+		for (size_t i = 0; i + 1 < resolved.path.size(); ++i) {
+			if (resolved.path[i]->is_repeated())
+				throw invalid_argument("Field '" + fieldPath + "' passes through a repeated field.");
+		}
+
+		lock_guard<mutex> lock(cacheMutex);
+
+		return cache.emplace(key, move(resolved)).first->second;
+	}
+
+	void SetField(Message *message, const FieldDescriptor *field, const any &value) {
+		const auto *reflection = message->GetReflection();
+
+		if (field->is_repeated()) {
+			switch (field->cpp_type()) {
+				case FieldDescriptor::CppType::CPPTYPE_INT32:
+					reflection->AddInt32(message, field, NumericCast<int32_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_INT64:
+					reflection->AddInt64(message, field, NumericCast<int64_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_UINT32:
+					reflection->AddUInt32(message, field, NumericCast<uint32_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_UINT64:
+					reflection->AddUInt64(message, field, NumericCast<uint64_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+					reflection->AddDouble(message, field, NumericCast<double>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_FLOAT:
+					reflection->AddFloat(message, field, NumericCast<float>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_BOOL:
+					reflection->AddBool(message, field, NumericCast<bool>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_ENUM:
+					reflection->AddEnumValue(message, field, EnumNumber(field, value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_STRING:
+					reflection->AddString(message, field, any_cast<string>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_MESSAGE:
+					reflection->AddMessage(message, field)->CopyFrom(*any_cast<shared_ptr<Message>>(value));
+					break;
+			}
+		}
+		else {
+			switch (field->cpp_type()) {
+				case FieldDescriptor::CppType::CPPTYPE_INT32:
+					reflection->SetInt32(message, field, NumericCast<int32_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_INT64:
+					reflection->SetInt64(message, field, NumericCast<int64_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_UINT32:
+					reflection->SetUInt32(message, field, NumericCast<uint32_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_UINT64:
+					reflection->SetUInt64(message, field, NumericCast<uint64_t>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+					reflection->SetDouble(message, field, NumericCast<double>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_FLOAT:
+					reflection->SetFloat(message, field, NumericCast<float>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_BOOL:
+					reflection->SetBool(message, field, NumericCast<bool>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_ENUM:
+					reflection->SetEnumValue(message, field, EnumNumber(field, value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_STRING:
+					reflection->SetString(message, field, any_cast<string>(value));
+					break;
+				case FieldDescriptor::CppType::CPPTYPE_MESSAGE:
+					reflection->MutableMessage(message, field)->CopyFrom(*any_cast<shared_ptr<Message>>(value));
+					break;
+			}
+		}
+	}
+
+	void SetPath(Message *message, const vector<const FieldDescriptor *> &path, const any &value) {
+		for (size_t i = 0; i + 1 < path.size(); ++i)
+			message = message->GetReflection()->MutableMessage(message, path[i]);
+
+		SetField(message, path.back(), value);
+	}
+}
+
+namespace mediapipe_solutions {
+
+CalculatorOption::CalculatorOption(string path, any value) {
+	vector<string> splitPath = absl::StrSplit(path, absl::MaxSplits('.', 1));
+
+	if (splitPath.size() != 2)
+		throw invalid_argument("Option '" + path + "' is not of the form node.field.");
+
+	node_ = move(splitPath[0]);
+	apply_ = [path = move(path), fieldPath = move(splitPath[1]), value = move(value)](CalculatorGraphConfig::Node &node) {
+		const auto resolved = Resolve(node, fieldPath);
+
+		try {
+			for (auto &nodeOptions : *node.mutable_node_options()) {
+				if (nodeOptions.type_url().substr(nodeOptions.type_url().rfind('/') + 1) == resolved.options_type->full_name()) {
+					unique_ptr<Message> options(
+						MessageFactory::generated_factory()->GetPrototype(resolved.options_type)->New());
+
+					nodeOptions.UnpackTo(options.get());
+					SetPath(options.get(), resolved.path, value);
+					nodeOptions.PackFrom(*options);
+					return;
+				}
+			}
+
+			if (!resolved.extension)
+				throw out_of_range("Options of " + node.calculator() + " cannot be set through CalculatorOptions.");
+
+			auto *options = node.mutable_options();
+
+			SetPath(options->GetReflection()->MutableMessage(options, resolved.extension), resolved.path, value);
+		}
+		catch (const bad_any_cast &) {
+			throw invalid_argument("Option '" + path + "' has a value of the wrong type.");
+		}
+		catch (const range_error &error) {
+			throw invalid_argument("Option '" + path + "' does not fit its field: " + error.what());
+		}
+	};
+}
+
+CalculatorOption::CalculatorOption(string node, function<void(CalculatorGraphConfig::Node &)> apply) :
+	node_(move(node)),
+	apply_(move(apply)) {
+}
+
+}	// namespace mediapipe_solutions
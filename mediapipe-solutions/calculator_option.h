@@ -0,0 +1,109 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_CALCULATOR_OPTION_H_
+#define MEDIAPIPE_SOLUTIONS_CALCULATOR_OPTION_H_
+
+#include <any>
+#include <functional>
+#include <string>
+
+#include "mediapipe/framework/calculator.pb.h"
+
+namespace mediapipe_solutions {
+
+template <typename T>
+struct TypeIdentity {
+	using type = T;
+};
+
+// A change to the options of one node of the expanded graph, applied before
+// the graph starts.
+//
+// The typed forms name the calculator options message and its setter, so a
+// wrong field name or value type fails to compile:
+//
+//   CalculatorOption::Set(
+//       "palmdetectioncpu__TensorsToDetectionsCalculator",
+//       &mediapipe::TensorsToDetectionsCalculatorOptions::set_min_score_thresh, 0.6f);
+//
+// The "node.field" form resolves the field through protobuf descriptors. The
+// options message is looked up by calculator type, whether or not the graph
+// sets it, and the lookup is cached per calculator type and field. Numbers
+// convert to the field's type only if their value survives, so Apply throws
+// std::invalid_argument for e.g. 2.5 or 1e10 given to an int32 field. Values
+// narrowed to a float field may round.
+class CalculatorOption {
+	public:
+		CalculatorOption(std::string path, std::any value);
+
+		template <typename OptionsT, typename ValueT>
+		static CalculatorOption Set(
+			std::string node, void (OptionsT::*setter)(ValueT), typename TypeIdentity<ValueT>::type value
+		);
+
+		template <typename OptionsT>
+		static CalculatorOption Modify(std::string node, std::function<void(OptionsT &)> modifier);
+
+		const std::string &node() const;
+		void Apply(mediapipe::CalculatorGraphConfig::Node &node) const;
+	private:
+		std::string node_;
+		std::function<void(mediapipe::CalculatorGraphConfig::Node &)> apply_;
+
+		CalculatorOption(std::string node, std::function<void(mediapipe::CalculatorGraphConfig::Node &)> apply);
+};
+
+template <typename OptionsT, typename ValueT>
+CalculatorOption CalculatorOption::Set(
+	std::string node, void (OptionsT::*setter)(ValueT), typename TypeIdentity<ValueT>::type value
+) {
+	return Modify<OptionsT>(
+		std::move(node),
+		[setter, value = std::move(value)](OptionsT &options) { (options.*setter)(value); }
+	);
+}
+
+template <typename OptionsT>
+CalculatorOption CalculatorOption::Modify(std::string node, std::function<void(OptionsT &)> modifier) {
+	return CalculatorOption(
+		std::move(node),
+		[modifier = std::move(modifier)](mediapipe::CalculatorGraphConfig::Node &node) {
+			for (auto &nodeOptions : *node.mutable_node_options()) {
+				if (nodeOptions.template Is<OptionsT>()) {
+					OptionsT options;
+
+					nodeOptions.UnpackTo(&options);
+					modifier(options);
+					nodeOptions.PackFrom(options);
+					return;
+				}
+			}
+
+			modifier(*node.mutable_options()->MutableExtension(OptionsT::ext));
+		}
+	);
+}
+
+inline const std::string &CalculatorOption::node() const {
+	return node_;
+}
+
+inline void CalculatorOption::Apply(mediapipe::CalculatorGraphConfig::Node &node) const {
+	apply_(node);
+}
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_CALCULATOR_OPTION_H_
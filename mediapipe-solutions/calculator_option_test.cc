@@ -0,0 +1,147 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/calculator_option.h"
+
+#include <any>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/calculators/util/thresholding_calculator.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+CalculatorGraphConfig::Node MakeNode(const string &name, const string &calculator) {
+	CalculatorGraphConfig::Node node;
+
+	node.set_name(name);
+	node.set_calculator(calculator);
+	return node;
+}
+
+TEST(CalculatorOptionTest, SplitsNodeFromField) {
+	const CalculatorOption option("threshold.threshold", 0.5);
+
+	EXPECT_EQ(option.node(), "threshold");
+	EXPECT_THROW(CalculatorOption("threshold", 0.5), invalid_argument);
+}
+
+TEST(CalculatorOptionTest, SetsFieldOfOptionsTheNodeLacks) {
+	auto node = MakeNode("threshold", "ThresholdingCalculator");
+
+	CalculatorOption("threshold.threshold", 0.7).Apply(node);
+
+	ASSERT_TRUE(node.options().HasExtension(ThresholdingCalculatorOptions::ext));
+	EXPECT_DOUBLE_EQ(node.options().GetExtension(ThresholdingCalculatorOptions::ext).threshold(), 0.7);
+}
+
+TEST(CalculatorOptionTest, ConvertsNumericValues) {
+	auto node = MakeNode("threshold", "ThresholdingCalculator");
+
+	CalculatorOption("threshold.threshold", 2).Apply(node);
+	EXPECT_DOUBLE_EQ(node.options().GetExtension(ThresholdingCalculatorOptions::ext).threshold(), 2.0);
+
+	CalculatorOption("threshold.threshold", 0.25f).Apply(node);
+	EXPECT_DOUBLE_EQ(node.options().GetExtension(ThresholdingCalculatorOptions::ext).threshold(), 0.25);
+}
+
+TEST(CalculatorOptionTest, RejectsLossyNumericValues) {
+	auto node = MakeNode("inference", "InferenceCalculator");
+
+	CalculatorOption("inference.delegate.xnnpack.num_threads", 4.0).Apply(node);
+	EXPECT_EQ(node.options().GetExtension(InferenceCalculatorOptions::ext).delegate().xnnpack().num_threads(), 4);
+
+	for (const any &value : { any(2.5), any(1e10), any(numeric_limits<double>::quiet_NaN()), any(int64_t(1) << 40), any(~0u) }) {
+		EXPECT_THROW(
+			CalculatorOption("inference.delegate.xnnpack.num_threads", value).Apply(node), invalid_argument
+		) << value.type().name();
+	}
+
+	EXPECT_EQ(node.options().GetExtension(InferenceCalculatorOptions::ext).delegate().xnnpack().num_threads(), 4);
+}
+
+TEST(CalculatorOptionTest, SetsNestedAndStringFields) {
+	auto node = MakeNode("inference", "InferenceCalculator");
+
+	CalculatorOption("inference.delegate.xnnpack.num_threads", 4).Apply(node);
+	CalculatorOption("inference.model_path", string("model.tflite")).Apply(node);
+
+	const auto &options = node.options().GetExtension(InferenceCalculatorOptions::ext);
+
+	EXPECT_EQ(options.delegate().xnnpack().num_threads(), 4);
+	EXPECT_EQ(options.model_path(), "model.tflite");
+}
+
+TEST(CalculatorOptionTest, KeepsOtherFieldsOfExistingOptions) {
+	auto node = MakeNode("inference", "InferenceCalculator");
+
+	node.mutable_options()->MutableExtension(InferenceCalculatorOptions::ext)->set_model_path("model.tflite");
+	CalculatorOption("inference.delegate.xnnpack.num_threads", 2).Apply(node);
+
+	const auto &options = node.options().GetExtension(InferenceCalculatorOptions::ext);
+
+	EXPECT_EQ(options.model_path(), "model.tflite");
+	EXPECT_EQ(options.delegate().xnnpack().num_threads(), 2);
+}
+
+TEST(CalculatorOptionTest, UpdatesNodeOptionsInPlace) {
+	auto node = MakeNode("threshold", "ThresholdingCalculator");
+	ThresholdingCalculatorOptions packed;
+
+	packed.set_threshold(0.1);
+	node.add_node_options()->PackFrom(packed);
+
+	CalculatorOption("threshold.threshold", 0.9).Apply(node);
+
+	ThresholdingCalculatorOptions unpacked;
+
+	ASSERT_EQ(node.node_options_size(), 1);
+	ASSERT_TRUE(node.node_options(0).UnpackTo(&unpacked));
+	EXPECT_DOUBLE_EQ(unpacked.threshold(), 0.9);
+	EXPECT_FALSE(node.options().HasExtension(ThresholdingCalculatorOptions::ext));
+}
+
+TEST(CalculatorOptionTest, RejectsUnknownFieldsAndCalculators) {
+	auto thresholding = MakeNode("threshold", "ThresholdingCalculator");
+	auto unknown = MakeNode("unknown", "NoSuchCalculator");
+
+	EXPECT_THROW(CalculatorOption("threshold.no_such_field", 1).Apply(thresholding), out_of_range);
+	EXPECT_THROW(CalculatorOption("threshold.threshold.nested", 1).Apply(thresholding), out_of_range);
+	EXPECT_THROW(CalculatorOption("unknown.threshold", 1).Apply(unknown), out_of_range);
+}
+
+TEST(CalculatorOptionTest, RejectsValuesOfTheWrongType) {
+	auto node = MakeNode("threshold", "ThresholdingCalculator");
+
+	EXPECT_THROW(CalculatorOption("threshold.threshold", string("high")).Apply(node), invalid_argument);
+}
+
+TEST(CalculatorOptionTest, TypedSetterSetsExtension) {
+	auto node = MakeNode("threshold", "ThresholdingCalculator");
+
+	CalculatorOption::Set("threshold", &ThresholdingCalculatorOptions::set_threshold, 0.3).Apply(node);
+
+	EXPECT_DOUBLE_EQ(node.options().GetExtension(ThresholdingCalculatorOptions::ext).threshold(), 0.3);
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
@@ -0,0 +1,104 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/framework/calculator_framework.h"
+
+#include "mediapipe-solutions/deadline.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	constexpr char kCountersTag[] = "COUNTERS";
+	constexpr char kDeadlineTag[] = "DEADLINE";
+}
+
+// Passes its untagged inputs through unless the frame's DEADLINE has passed,
+// in which case it drops all of them and counts the frame under the node name
+// in the optional COUNTERS. Timestamps without any input, e.g. frames an
+// earlier gate dropped, are not counted. Neither are frames an earlier gate
+// counted already, which can still reach this one through an input that
+// bypasses that gate.
+//
+// Example config:
+// node {
+//   name: "input_deadline"
+//   calculator: "DeadlineGateCalculator"
+//   input_stream: "input_video"
+//   input_stream: "DEADLINE:deadline"
+//   input_side_packet: "COUNTERS:deadline_counters"
+//   output_stream: "input_video__input_deadline"
+// }
+class DeadlineGateCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			for (int i = 0; i < cc->Inputs().NumEntries(""); ++i) {
+				cc->Inputs().Get("", i).SetAny();
+				cc->Outputs().Get("", i).SetSameAs(&cc->Inputs().Get("", i));
+			}
+
+			cc->Inputs().Tag(kDeadlineTag).Set<int64_t>();
+
+			if (cc->InputSidePackets().HasTag(kCountersTag))
+				cc->InputSidePackets().Tag(kCountersTag).Set<shared_ptr<DeadlineCounters>>().Optional();
+
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+
+			if (cc->InputSidePackets().HasTag(kCountersTag) and !cc->InputSidePackets().Tag(kCountersTag).IsEmpty())
+				counters_ = cc->InputSidePackets().Tag(kCountersTag).Get<shared_ptr<DeadlineCounters>>();
+
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			const auto &deadline = cc->Inputs().Tag(kDeadlineTag);
+			bool hasInput = false;
+
+			// DEADLINE arrives for every frame, so Process also runs for frames
+			// that carry no data here.
+			for (int i = 0; i < cc->Inputs().NumEntries(""); ++i)
+				hasInput = hasInput or !cc->Inputs().Get("", i).IsEmpty();
+
+			if (!hasInput)
+				return absl::OkStatus();
+
+			if (!deadline.IsEmpty() and DeadlinePassed(deadline.Get<int64_t>())) {
+				if (counters_)
+					counters_->Drop(cc->NodeName(), cc->InputTimestamp().Value());
+
+				return absl::OkStatus();
+			}
+
+			for (int i = 0; i < cc->Inputs().NumEntries(""); ++i) {
+				if (!cc->Inputs().Get("", i).IsEmpty())
+					cc->Outputs().Get("", i).AddPacket(cc->Inputs().Get("", i).Value());
+			}
+
+			return absl::OkStatus();
+		}
+	private:
+		shared_ptr<DeadlineCounters> counters_;
+};
+REGISTER_CALCULATOR(DeadlineGateCalculator);
+
+}	// namespace mediapipe_solutions
@@ -0,0 +1,151 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+#include "mediapipe-solutions/deadline.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+constexpr int64_t kNoDeadline = numeric_limits<int64_t>::max();
+constexpr int64_t kExpired = 0;
+
+// "input" goes through a stream gate, then a node gate in front of the
+// PassThroughCalculator, as in the hands graph. "config" only passes the node
+// gate, like the live parameters a BeginLoop clones.
+class DeadlineGateCalculatorTest : public ::testing::Test {
+	protected:
+		shared_ptr<DeadlineCounters> counters_ = make_shared<DeadlineCounters>();
+		vector<Packet> outputs_;
+		CalculatorGraph graph_;
+
+		void SetUp() override {
+			auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+				input_stream: "input"
+				input_stream: "config"
+				output_stream: "output"
+				node {
+					name: "pass"
+					calculator: "PassThroughCalculator"
+					input_stream: "input"
+					input_stream: "config"
+					output_stream: "output"
+					output_stream: "config_output"
+				}
+			)pb");
+
+			AddDeadlineGate(config, "input", "first_gate");
+			AddDeadlineGate(config, *config.mutable_node(0), "second_gate");
+
+			ASSERT_TRUE(graph_.Initialize(config).ok());
+			ASSERT_TRUE(graph_.ObserveOutputStream("output", [this](const Packet &packet) {
+				outputs_.push_back(packet);
+				return absl::OkStatus();
+			}).ok());
+			ASSERT_TRUE(graph_.StartRun({ { kDeadlineCountersSidePacket, MakePacket<shared_ptr<DeadlineCounters>>(counters_) } }).ok());
+		}
+
+		void Send(int64_t timestamp, int64_t deadline, bool withInput = true, bool withConfig = false) {
+			ASSERT_TRUE(graph_.AddPacketToInputStream(kDeadlineStream, MakePacket<int64_t>(deadline).At(Timestamp(timestamp))).ok());
+
+			if (withInput)
+				ASSERT_TRUE(graph_.AddPacketToInputStream("input", MakePacket<int>(int(timestamp)).At(Timestamp(timestamp))).ok());
+
+			if (withConfig)
+				ASSERT_TRUE(graph_.AddPacketToInputStream("config", MakePacket<double>(0.5).At(Timestamp(timestamp))).ok());
+		}
+
+		void Finish() {
+			ASSERT_TRUE(graph_.CloseAllPacketSources().ok());
+			ASSERT_TRUE(graph_.WaitUntilDone().ok());
+		}
+};
+
+TEST_F(DeadlineGateCalculatorTest, PassesFramesBeforeTheirDeadline) {
+	Send(1, kNoDeadline);
+	Send(2, kNoDeadline);
+	Finish();
+
+	ASSERT_EQ(outputs_.size(), 2u);
+	EXPECT_EQ(outputs_[0].Get<int>(), 1);
+	EXPECT_EQ(outputs_[1].Get<int>(), 2);
+	EXPECT_TRUE(counters_->Snapshot().empty());
+}
+
+TEST_F(DeadlineGateCalculatorTest, CountsALateFrameOnlyWhereItIsDropped) {
+	Send(1, kNoDeadline);
+	Send(2, kExpired);
+	Send(3, kNoDeadline);
+	Finish();
+
+	ASSERT_EQ(outputs_.size(), 2u);
+	EXPECT_EQ(outputs_[0].Get<int>(), 1);
+	EXPECT_EQ(outputs_[1].Get<int>(), 3);
+
+	// The second gate also runs at timestamp 2, but without data.
+	EXPECT_EQ(counters_->Snapshot(), (map<string, uint64_t> { { "first_gate", 1 } }));
+	EXPECT_TRUE(counters_->TakeDropped(2));
+	EXPECT_FALSE(counters_->TakeDropped(1));
+}
+
+TEST_F(DeadlineGateCalculatorTest, CountsAFrameOnceWhenAnInputBypassesTheFirstGate) {
+	Send(1, kNoDeadline, /*withInput=*/true, /*withConfig=*/true);
+	Send(2, kExpired, /*withInput=*/true, /*withConfig=*/true);
+	Send(3, kNoDeadline, /*withInput=*/true, /*withConfig=*/true);
+	Finish();
+
+	ASSERT_EQ(outputs_.size(), 2u);
+	EXPECT_EQ(outputs_[0].Get<int>(), 1);
+	EXPECT_EQ(outputs_[1].Get<int>(), 3);
+
+	// The second gate sees config at timestamp 2 and drops it, but the frame
+	// was counted by the first gate.
+	EXPECT_EQ(counters_->Snapshot(), (map<string, uint64_t> { { "first_gate", 1 } }));
+	EXPECT_TRUE(counters_->TakeDropped(2));
+}
+
+TEST_F(DeadlineGateCalculatorTest, CountsAtTheSecondGateWhatOnlyItDrops) {
+	// Only config arrives, so the first gate has nothing to drop.
+	Send(1, kExpired, /*withInput=*/false, /*withConfig=*/true);
+	Finish();
+
+	EXPECT_TRUE(outputs_.empty());
+	EXPECT_EQ(counters_->Snapshot(), (map<string, uint64_t> { { "second_gate", 1 } }));
+}
+
+TEST_F(DeadlineGateCalculatorTest, IgnoresDeadlinesWithoutFrames) {
+	Send(1, kExpired, /*withInput=*/false);
+	Send(2, kExpired, /*withInput=*/false);
+	Send(3, kNoDeadline);
+	Finish();
+
+	ASSERT_EQ(outputs_.size(), 1u);
+	EXPECT_TRUE(counters_->Snapshot().empty());
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
@@ -0,0 +1,140 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/deadline.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "mediapipe/framework/tool/validate_name.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+void DeadlineCounters::Increment(const string &stage) {
+	lock_guard<mutex> lock(mutex_);
+
+	++counts_[stage];
+}
+
+void DeadlineCounters::Drop(const string &stage, int64_t timestamp) {
+	lock_guard<mutex> lock(mutex_);
+
+	if (dropped_.insert(timestamp).second)
+		++counts_[stage];
+}
+
+bool DeadlineCounters::TakeDropped(int64_t timestamp) {
+	lock_guard<mutex> lock(mutex_);
+
+	return dropped_.erase(timestamp) != 0;
+}
+
+map<string, uint64_t> DeadlineCounters::Snapshot() const {
+	lock_guard<mutex> lock(mutex_);
+
+	return counts_;
+}
+
+int64_t ToDeadlineValue(optional<steady_clock::time_point> deadline) {
+	if (!deadline)
+		return numeric_limits<int64_t>::max();
+
+	return duration_cast<microseconds>(deadline->time_since_epoch()).count();
+}
+
+bool DeadlinePassed(int64_t deadline) {
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count() > deadline;
+}
+
+namespace {
+	string ParseStreamName(const string &stream) {
+		string tag, name;
+		int index;
+
+		const auto status = tool::ParseTagIndexName(stream, &tag, &index, &name);
+
+		if (!status.ok())
+			throw invalid_argument(string(status.message()));
+
+		return name;
+	}
+
+	// Points stream at the gated copy of its stream, keeping tag and index.
+	string Gated(const string &stream, const string &gate_name) {
+		return stream + "__" + gate_name;
+	}
+
+	CalculatorGraphConfig::Node &AddGateNode(CalculatorGraphConfig &config, const string &gate_name) {
+		const auto &inputs = config.input_stream();
+
+		if (find(inputs.begin(), inputs.end(), kDeadlineStream) == inputs.end())
+			config.add_input_stream(kDeadlineStream);
+
+		auto &gate = *config.add_node();
+
+		gate.set_name(gate_name);
+		gate.set_calculator("DeadlineGateCalculator");
+		gate.add_input_stream("DEADLINE:"s + kDeadlineStream);
+		gate.add_input_side_packet("COUNTERS:"s + kDeadlineCountersSidePacket);
+		return gate;
+	}
+}
+
+void AddDeadlineGate(CalculatorGraphConfig &config, const string &stream, const string &gate_name) {
+	AddDeadlineGate(config, vector<string> { stream }, gate_name);
+}
+
+void AddDeadlineGate(CalculatorGraphConfig &config, const vector<string> &streams, const string &gate_name) {
+	const set<string> gated(streams.begin(), streams.end());
+
+	for (auto &node : *config.mutable_node()) {
+		for (auto &input : *node.mutable_input_stream()) {
+			if (gated.count(ParseStreamName(input)))
+				input = Gated(input, gate_name);
+		}
+	}
+
+	auto &gate = AddGateNode(config, gate_name);
+
+	for (const auto &stream : streams) {
+		gate.add_input_stream(stream);
+		gate.add_output_stream(Gated(stream, gate_name));
+	}
+}
+
+void AddDeadlineGate(CalculatorGraphConfig &config, CalculatorGraphConfig::Node &node, const string &gate_name) {
+	set<string> streams;
+
+	for (auto &input : *node.mutable_input_stream()) {
+		streams.insert(ParseStreamName(input));
+		input = Gated(input, gate_name);
+	}
+
+	// Elements of a repeated field keep their address as it grows.
+	auto &gate = AddGateNode(config, gate_name);
+
+	for (const auto &stream : streams) {
+		gate.add_input_stream(stream);
+		gate.add_output_stream(Gated(stream, gate_name));
+	}
+}
+
+}	// namespace mediapipe_solutions
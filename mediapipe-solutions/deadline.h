@@ -0,0 +1,88 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_DEADLINE_H_
+#define MEDIAPIPE_SOLUTIONS_DEADLINE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+
+namespace mediapipe_solutions {
+
+// Graph input stream with the deadline of every frame, an int64 as returned
+// by ToDeadlineValue. SolutionBase feeds it whenever the graph declares it.
+constexpr char kDeadlineStream[] = "deadline";
+
+// Side packet with the std::shared_ptr<DeadlineCounters> of the solution.
+constexpr char kDeadlineCountersSidePacket[] = "deadline_counters";
+
+// Frames dropped for missing their deadline, per stage. Calculators count
+// under their node name.
+class DeadlineCounters {
+	public:
+		void Increment(const std::string &stage);
+
+		// Counts a frame that a calculator dropped at timestamp under stage,
+		// unless an earlier stage already dropped it, e.g. when an input of a
+		// later gate bypasses the first one. Remembers the timestamp until
+		// TakeDropped, so that its empty result is not counted again either.
+		void Drop(const std::string &stage, int64_t timestamp);
+		// Returns whether timestamp was dropped and forgets it. Must be called
+		// once for every timestamp that reaches a gate.
+		bool TakeDropped(int64_t timestamp);
+
+		std::map<std::string, uint64_t> Snapshot() const;
+	private:
+		mutable std::mutex mutex_;
+		std::map<std::string, uint64_t> counts_;
+		std::set<int64_t> dropped_;
+};
+
+// Microseconds of the steady clock, or the largest int64 for no deadline.
+int64_t ToDeadlineValue(std::optional<std::chrono::steady_clock::time_point> deadline);
+
+bool DeadlinePassed(int64_t deadline);
+
+// Sends stream through a DeadlineGateCalculator named gate_name, which drops
+// the frames that missed their deadline. Every node consuming stream so far
+// reads the gated stream instead. Declares kDeadlineStream if needed.
+void AddDeadlineGate(mediapipe::CalculatorGraphConfig &config, const std::string &stream, const std::string &gate_name);
+
+// Gates several streams in one node, so that each of them loses the late
+// frames at the same stage.
+void AddDeadlineGate(
+	mediapipe::CalculatorGraphConfig &config,
+	const std::vector<std::string> &streams,
+	const std::string &gate_name
+);
+
+// Gates all inputs of node together and only for node, e.g. to stop a late
+// frame before an expensive stage without holding back the rest of the graph.
+void AddDeadlineGate(
+	mediapipe::CalculatorGraphConfig &config,
+	mediapipe::CalculatorGraphConfig::Node &node,
+	const std::string &gate_name
+);
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_DEADLINE_H_
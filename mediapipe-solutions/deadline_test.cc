@@ -0,0 +1,173 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/deadline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+const CalculatorGraphConfig::Node &FindNode(const CalculatorGraphConfig &config, const string &name) {
+	for (const auto &node : config.node()) {
+		if (node.name() == name)
+			return node;
+	}
+
+	throw out_of_range("No such node: " + name);
+}
+
+vector<string> Inputs(const CalculatorGraphConfig::Node &node) {
+	return vector<string>(node.input_stream().begin(), node.input_stream().end());
+}
+
+TEST(DeadlineTest, DeadlineValues) {
+	EXPECT_EQ(ToDeadlineValue(nullopt), numeric_limits<int64_t>::max());
+	EXPECT_FALSE(DeadlinePassed(ToDeadlineValue(nullopt)));
+	EXPECT_FALSE(DeadlinePassed(ToDeadlineValue(steady_clock::now() + seconds(60))));
+	EXPECT_TRUE(DeadlinePassed(ToDeadlineValue(steady_clock::now() - milliseconds(1))));
+}
+
+TEST(DeadlineTest, CountersRememberDroppedTimestampsOnce) {
+	DeadlineCounters counters;
+
+	counters.Increment("submit");
+	counters.Drop("gate", 20);
+
+	EXPECT_TRUE(counters.TakeDropped(20));
+	EXPECT_FALSE(counters.TakeDropped(20));
+	EXPECT_FALSE(counters.TakeDropped(10));
+	EXPECT_EQ(counters.Snapshot(), (map<string, uint64_t> { { "gate", 1 }, { "submit", 1 } }));
+}
+
+TEST(DeadlineTest, CountersCountADroppedFrameUnderTheFirstStage) {
+	DeadlineCounters counters;
+
+	counters.Drop("first", 20);
+	counters.Drop("second", 20);
+	counters.Drop("second", 30);
+
+	EXPECT_EQ(counters.Snapshot(), (map<string, uint64_t> { { "first", 1 }, { "second", 1 } }));
+	EXPECT_TRUE(counters.TakeDropped(20));
+	EXPECT_TRUE(counters.TakeDropped(30));
+}
+
+TEST(DeadlineTest, StreamGateRewiresEveryConsumer) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+		input_stream: "input_video"
+		node { name: "a" calculator: "A" input_stream: "IMAGE:input_video" output_stream: "a" }
+		node { name: "b" calculator: "B" input_stream: "input_video" input_stream: "a" output_stream: "b" }
+	)pb");
+
+	AddDeadlineGate(config, "input_video", "input_deadline");
+
+	EXPECT_EQ(Inputs(FindNode(config, "a")), vector<string> { "IMAGE:input_video__input_deadline" });
+	EXPECT_EQ(Inputs(FindNode(config, "b")), (vector<string> { "input_video__input_deadline", "a" }));
+
+	const auto &gate = FindNode(config, "input_deadline");
+
+	EXPECT_EQ(gate.calculator(), "DeadlineGateCalculator");
+	EXPECT_EQ(Inputs(gate), (vector<string> { "DEADLINE:deadline", "input_video" }));
+	ASSERT_EQ(gate.output_stream_size(), 1);
+	EXPECT_EQ(gate.output_stream(0), "input_video__input_deadline");
+	ASSERT_EQ(gate.input_side_packet_size(), 1);
+	EXPECT_EQ(gate.input_side_packet(0), "COUNTERS:deadline_counters");
+	EXPECT_EQ(
+		vector<string>(config.input_stream().begin(), config.input_stream().end()),
+		(vector<string> { "input_video", "deadline" })
+	);
+}
+
+TEST(DeadlineTest, StreamGateCoversSeveralStreams) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+		input_stream: "input_video"
+		input_stream: "threshold"
+		node { name: "a" calculator: "A" input_stream: "IMAGE:input_video" input_stream: "THRESHOLD:threshold" output_stream: "a" }
+	)pb");
+
+	AddDeadlineGate(config, vector<string> { "input_video", "threshold" }, "input_deadline");
+
+	EXPECT_EQ(
+		Inputs(FindNode(config, "a")),
+		(vector<string> { "IMAGE:input_video__input_deadline", "THRESHOLD:threshold__input_deadline" })
+	);
+
+	const auto &gate = FindNode(config, "input_deadline");
+
+	EXPECT_EQ(Inputs(gate), (vector<string> { "DEADLINE:deadline", "input_video", "threshold" }));
+	EXPECT_EQ(
+		vector<string>(gate.output_stream().begin(), gate.output_stream().end()),
+		(vector<string> { "input_video__input_deadline", "threshold__input_deadline" })
+	);
+}
+
+TEST(DeadlineTest, NodeGateOnlyRewiresThatNode) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+		input_stream: "image"
+		input_stream: "rect"
+		node { name: "landmarks" calculator: "A" input_stream: "IMAGE:image" input_stream: "ROI:rect" output_stream: "landmarks" }
+		node { name: "other" calculator: "B" input_stream: "image" output_stream: "other" }
+	)pb");
+
+	AddDeadlineGate(config, *config.mutable_node(0), "landmark_deadline");
+
+	EXPECT_EQ(
+		Inputs(FindNode(config, "landmarks")),
+		(vector<string> { "IMAGE:image__landmark_deadline", "ROI:rect__landmark_deadline" })
+	);
+	EXPECT_EQ(Inputs(FindNode(config, "other")), vector<string> { "image" });
+
+	const auto &gate = FindNode(config, "landmark_deadline");
+
+	EXPECT_EQ(Inputs(gate), (vector<string> { "DEADLINE:deadline", "image", "rect" }));
+	EXPECT_EQ(
+		vector<string>(gate.output_stream().begin(), gate.output_stream().end()),
+		(vector<string> { "image__landmark_deadline", "rect__landmark_deadline" })
+	);
+}
+
+TEST(DeadlineTest, DeclaresTheDeadlineStreamOnce) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+		input_stream: "input"
+		node { name: "a" calculator: "A" input_stream: "input" output_stream: "a" }
+	)pb");
+
+	AddDeadlineGate(config, "input", "first");
+	AddDeadlineGate(config, "a", "second");
+
+	EXPECT_EQ(count(config.input_stream().begin(), config.input_stream().end(), kDeadlineStream), 1);
+}
+
+TEST(DeadlineTest, RejectsMalformedStreams) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+		node { name: "a" calculator: "A" input_stream: "A:B:C:D" }
+	)pb");
+
+	EXPECT_THROW(AddDeadlineGate(config, "input", "gate"), invalid_argument);
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
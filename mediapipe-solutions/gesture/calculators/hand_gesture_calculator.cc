@@ -0,0 +1,83 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+#include "mediapipe-solutions/gesture/gesture_classifier.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	constexpr char kGesturesTag[] = "GESTURES";
+	constexpr char kLandmarksTag[] = "LANDMARKS";
+}
+
+// Scores the gestures of every hand of a frame with GestureClassifier. Emits
+// one ClassificationList per hand, in the order of LANDMARKS, with one
+// classification per Gesture: its index, its name from kGestureNames and its
+// score.
+//
+// Example config:
+// node {
+//   calculator: "HandGestureCalculator"
+//   input_stream: "LANDMARKS:landmarks"
+//   output_stream: "GESTURES:hand_gestures"
+// }
+class HandGestureCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			cc->Inputs().Tag(kLandmarksTag).Set<vector<NormalizedLandmarkList>>();
+			cc->Outputs().Tag(kGesturesTag).Set<vector<ClassificationList>>();
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			if (cc->Inputs().Tag(kLandmarksTag).IsEmpty())
+				return absl::OkStatus();
+
+			const auto &hands = cc->Inputs().Tag(kLandmarksTag).Get<vector<NormalizedLandmarkList>>();
+			const auto scores = classifier_.Classify(hands);
+			auto gestures = absl::make_unique<vector<ClassificationList>>(scores.size());
+
+			for (size_t i = 0; i < scores.size(); ++i) {
+				for (int gesture = 0; gesture < kNumGestures; ++gesture) {
+					auto &classification = *(*gestures)[i].add_classification();
+
+					classification.set_index(gesture);
+					classification.set_label(kGestureNames[gesture]);
+					classification.set_score(scores[i].scores[gesture]);
+				}
+			}
+
+			cc->Outputs().Tag(kGesturesTag).Add(gestures.release(), cc->InputTimestamp());
+			return absl::OkStatus();
+		}
+	private:
+		GestureClassifier classifier_;
+};
+REGISTER_CALCULATOR(HandGestureCalculator);
+
+}	// namespace mediapipe_solutions
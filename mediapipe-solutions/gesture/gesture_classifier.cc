@@ -0,0 +1,197 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/gesture/gesture_classifier.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+const char *const kGestureNames[kNumGestures] = { "PINCH", "OPEN_PALM", "POINTING" };
+
+namespace {
+	constexpr int kNumHandLandmarks = 21;
+
+	// The landmarks the features use, in the order they are gathered.
+	enum Point {
+		WRIST,
+		THUMB_IP,
+		THUMB_TIP,
+		INDEX_FINGER_MCP,
+		INDEX_FINGER_PIP,
+		INDEX_FINGER_TIP,
+		MIDDLE_FINGER_MCP,
+		MIDDLE_FINGER_PIP,
+		MIDDLE_FINGER_TIP,
+		RING_FINGER_PIP,
+		RING_FINGER_TIP,
+		PINKY_PIP,
+		PINKY_TIP,
+		kNumPoints,
+	};
+
+	// Hand landmark index of every Point.
+	constexpr int kPointLandmarks[kNumPoints] = { 0, 3, 4, 5, 6, 8, 9, 10, 12, 14, 16, 18, 20 };
+
+	// Feature ranges, in squared hand sizes, over which a score goes from 0 to
+	// 1. The hand size is the distance from the wrist to the middle finger
+	// MCP. A finger is extended when its tip is farther from the wrist than
+	// its PIP joint, and the thumb when its tip is farther from the index
+	// finger MCP than its IP joint.
+	constexpr float kFingerCurled = -0.2f, kFingerExtended = 0.8f;
+	constexpr float kThumbCurled = 0.f, kThumbExtended = 0.3f;
+	// Squared distance of the thumb and index finger tips.
+	constexpr float kPinchClosed = 0.02f, kPinchOpen = 0.1f;
+
+	// Selects on values, for the branch-free kernel below.
+	inline float Min(float a, float b) {
+		return a < b ? a : b;
+	}
+
+	inline float Max(float a, float b) {
+		return a > b ? a : b;
+	}
+
+	inline float Ramp(float value, float zero, float one) {
+		return Min(Max((value - zero) * (1.f / (one - zero)), 0.f), 1.f);
+	}
+
+	constexpr int kBlockSize = GestureClassifier::kBlockSize;
+
+	inline float DistanceSquared(const float *coordinates, Point a, Point b, int i) {
+		float distance = 0.f;
+
+		for (int axis = 0; axis < 3; ++axis) {
+			const float delta = coordinates[(a * 3 + axis) * kBlockSize + i] - coordinates[(b * 3 + axis) * kBlockSize + i];
+
+			distance += delta * delta;
+		}
+
+		return distance;
+	}
+
+	inline const NormalizedLandmarkList &Hand(absl::Span<const NormalizedLandmarkList *const> hands, size_t i) {
+		return *hands[i];
+	}
+
+	inline const NormalizedLandmarkList &Hand(absl::Span<const NormalizedLandmarkList> hands, size_t i) {
+		return hands[i];
+	}
+
+	// One iteration per hand, without branches, so that it vectorizes. Kept
+	// out of line: once inlined, GCC no longer if-converts the clamps.
+	__attribute__((noinline)) void ScoreKernel(
+		const float *__restrict coordinates, const float *__restrict complete, float *__restrict scores, int count
+	) {
+		for (int i = 0; i < count; ++i) {
+			// Offset rather than clamped away from 0; a branch around the
+			// division would keep it from being if-converted.
+			const float scale = 1.f / (DistanceSquared(coordinates, WRIST, MIDDLE_FINGER_MCP, i) + 1e-12f);
+
+			const auto finger = [&](Point pip, Point tip) {
+				const float extension = (
+					DistanceSquared(coordinates, WRIST, tip, i) - DistanceSquared(coordinates, WRIST, pip, i)
+				) * scale;
+
+				return Ramp(extension, kFingerCurled, kFingerExtended);
+			};
+
+			const float thumbExtension = (
+				DistanceSquared(coordinates, INDEX_FINGER_MCP, THUMB_TIP, i)
+				- DistanceSquared(coordinates, INDEX_FINGER_MCP, THUMB_IP, i)
+			) * scale;
+			const float pinch = DistanceSquared(coordinates, THUMB_TIP, INDEX_FINGER_TIP, i) * scale;
+
+			const float thumb = Ramp(thumbExtension, kThumbCurled, kThumbExtended);
+			const float index = finger(INDEX_FINGER_PIP, INDEX_FINGER_TIP);
+			const float middle = finger(MIDDLE_FINGER_PIP, MIDDLE_FINGER_TIP);
+			const float ring = finger(RING_FINGER_PIP, RING_FINGER_TIP);
+			const float pinky = finger(PINKY_PIP, PINKY_TIP);
+
+			// The thumb reaches out to the index finger in a pinch but lies next
+			// to it in a fist, where the tips may be just as close.
+			scores[int(Gesture::PINCH) * kBlockSize + i] = complete[i] * Min(1.f - Ramp(pinch, kPinchClosed, kPinchOpen), thumb);
+			scores[int(Gesture::OPEN_PALM) * kBlockSize + i] = complete[i] * Min(Min(Min(thumb, index), Min(middle, ring)), pinky);
+			scores[int(Gesture::POINTING) * kBlockSize + i] = complete[i] * Min(Min(index, 1.f - middle), Min(1.f - ring, 1.f - pinky));
+		}
+	}
+}
+
+vector<GestureScores> GestureClassifier::Classify(absl::Span<const NormalizedLandmarkList *const> hands) {
+	return ClassifyBlocks(hands);
+}
+
+vector<GestureScores> GestureClassifier::Classify(absl::Span<const NormalizedLandmarkList> hands) {
+	return ClassifyBlocks(hands);
+}
+
+template <typename Hands>
+vector<GestureScores> GestureClassifier::ClassifyBlocks(const Hands &hands) {
+	vector<GestureScores> results(hands.size());
+
+	// Fixed blocks keep the arrays in the L1 cache. Whole batches laid out
+	// this way put their arrays a power of two apart, where they evict each
+	// other.
+	for (size_t begin = 0; begin < hands.size(); begin += kBlockSize) {
+		const int count = int(min(hands.size() - begin, size_t(kBlockSize)));
+
+		for (int i = 0; i < count; ++i)
+			Gather(i, Hand(hands, begin + i));
+
+		// Rounded up to whole vectors; the scores past count are not returned.
+		ScoreKernel(coordinates_.data(), complete_.data(), scores_.data(), min((count + 7) & ~7, kBlockSize));
+
+		for (int gesture = 0; gesture < kNumGestures; ++gesture) {
+			for (int i = 0; i < count; ++i)
+				results[begin + i].scores[gesture] = scores_[gesture * kBlockSize + i];
+		}
+	}
+
+	return results;
+}
+
+void GestureClassifier::Gather(int index, const NormalizedLandmarkList &hand) {
+	// An incomplete hand is gathered as zeros and its scores masked to 0.
+	const bool complete = hand.landmark_size() >= kNumHandLandmarks;
+
+	complete_[index] = complete ? 1.f : 0.f;
+
+	for (int point = 0; point < kNumPoints; ++point) {
+		float *coordinates = &coordinates_[point * 3 * kBlockSize + index];
+
+		if (!complete) {
+			coordinates[0] = coordinates[kBlockSize] = coordinates[2 * kBlockSize] = 0.f;
+			continue;
+		}
+
+		const auto &landmark = hand.landmark(kPointLandmarks[point]);
+
+		coordinates[0] = landmark.x();
+		coordinates[kBlockSize] = landmark.y();
+		coordinates[2 * kBlockSize] = landmark.z();
+	}
+}
+
+vector<GestureScores> ClassifyGestures(absl::Span<const NormalizedLandmarkList *const> hands) {
+	return GestureClassifier().Classify(hands);
+}
+
+vector<GestureScores> ClassifyGestures(absl::Span<const NormalizedLandmarkList> hands) {
+	return GestureClassifier().Classify(hands);
+}
+
+}	// namespace mediapipe_solutions
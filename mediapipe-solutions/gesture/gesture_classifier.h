@@ -0,0 +1,91 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_GESTURE_GESTURE_CLASSIFIER_H_
+#define MEDIAPIPE_SOLUTIONS_GESTURE_GESTURE_CLASSIFIER_H_
+
+#include <array>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe_solutions {
+
+enum class Gesture {
+	// Thumb tip touching the index finger tip.
+	PINCH = 0,
+	// All fingers extended.
+	OPEN_PALM = 1,
+	// Index finger extended, the other fingers curled.
+	POINTING = 2,
+};
+
+constexpr int kNumGestures = 3;
+
+// Names of the gestures, indexed by Gesture.
+extern const char *const kGestureNames[kNumGestures];
+
+// Score of every gesture in [0, 1], indexed by Gesture. The scores are
+// independent; a hand may score high on none or, e.g., on both PINCH and
+// OPEN_PALM.
+struct GestureScores {
+	std::array<float, kNumGestures> scores {};
+
+	float score(Gesture gesture) const;
+};
+
+// Scores the gestures of many hands at once, e.g. the hands of many frames
+// or streams.
+//
+// Hands are processed in blocks of kBlockSize. The landmarks of a block are
+// gathered into one array per coordinate, so the features and scores are
+// computed by loops over the block that the compiler vectorizes. Features
+// are ratios of squared distances, normalized by the size of the hand, so
+// they do not depend on its distance from the camera. Hands with fewer than
+// 21 landmarks score 0.
+//
+// A classifier must not be used by two threads at once.
+class GestureClassifier {
+	public:
+		static constexpr int kBlockSize = 64;
+
+		std::vector<GestureScores> Classify(absl::Span<const mediapipe::NormalizedLandmarkList *const> hands);
+		std::vector<GestureScores> Classify(absl::Span<const mediapipe::NormalizedLandmarkList> hands);
+	private:
+		// 13 landmarks, 3 coordinates each; axis a of landmark l starts at
+		// (l * 3 + a) * kBlockSize.
+		std::array<float, 13 * 3 * kBlockSize> coordinates_ {};
+		// 1 for hands with all landmarks, 0 otherwise.
+		std::array<float, kBlockSize> complete_ {};
+		// Gesture g starts at g * kBlockSize.
+		std::array<float, kNumGestures * kBlockSize> scores_ {};
+
+		template <typename Hands>
+		std::vector<GestureScores> ClassifyBlocks(const Hands &hands);
+
+		void Gather(int index, const mediapipe::NormalizedLandmarkList &hand);
+};
+
+// Convenience for one-off batches with a temporary classifier.
+std::vector<GestureScores> ClassifyGestures(absl::Span<const mediapipe::NormalizedLandmarkList *const> hands);
+std::vector<GestureScores> ClassifyGestures(absl::Span<const mediapipe::NormalizedLandmarkList> hands);
+
+inline float GestureScores::score(Gesture gesture) const {
+	return scores[int(gesture)];
+}
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_GESTURE_GESTURE_CLASSIFIER_H_
@@ -0,0 +1,171 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/gesture/gesture_classifier.h"
+
+#include <array>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+enum Finger { THUMB, INDEX, MIDDLE, RING, PINKY };
+
+// A right hand seen from the front, wrist at the origin and fingers along -y,
+// with the wrist to middle finger MCP distance as unit.
+NormalizedLandmarkList MakeHand(array<bool, 5> extended, bool pinch = false, float scale = 1.f, float offset = 0.f) {
+	array<array<float, 2>, 21> points {};
+	const float fingerX[5] = { 0.f, -0.1f, 0.f, 0.1f, 0.2f };
+
+	for (int finger = INDEX; finger <= PINKY; ++finger) {
+		const int mcp = 1 + 4 * finger;
+		const float x = fingerX[finger];
+
+		points[mcp] = { x, -1.f };
+		points[mcp + 1] = { x, -1.45f };
+
+		if (extended[finger]) {
+			points[mcp + 2] = { x, -1.7f };
+			points[mcp + 3] = { x, -1.92f };
+		}
+		else {
+			points[mcp + 2] = { x, -1.2f };
+			points[mcp + 3] = { x, -0.9f };
+		}
+	}
+
+	points[1] = { -0.2f, -0.2f };
+	points[2] = { -0.4f, -0.45f };
+	points[3] = { -0.55f, -0.65f };
+	points[4] = extended[THUMB] ? array<float, 2> { -0.8f, -0.6f } : array<float, 2> { -0.2f, -0.8f };
+
+	// Thumb tip on the index finger tip.
+	if (pinch)
+		points[4] = { points[8][0] - 0.02f, points[8][1] };
+
+	NormalizedLandmarkList hand;
+
+	for (const auto &point : points) {
+		auto &landmark = *hand.add_landmark();
+
+		landmark.set_x(point[0] * scale + offset);
+		landmark.set_y(point[1] * scale + offset);
+		landmark.set_z(0.f);
+	}
+
+	return hand;
+}
+
+const NormalizedLandmarkList kOpenPalm = MakeHand({ true, true, true, true, true });
+const NormalizedLandmarkList kPointing = MakeHand({ false, true, false, false, false });
+const NormalizedLandmarkList kPinch = MakeHand({ true, true, true, true, true }, /*pinch=*/true);
+const NormalizedLandmarkList kFist = MakeHand({ false, false, false, false, false });
+
+GestureScores ClassifyOne(const NormalizedLandmarkList &hand) {
+	return ClassifyGestures(absl::Span<const NormalizedLandmarkList>(&hand, 1)).at(0);
+}
+
+TEST(GestureClassifierTest, RecognizesOpenPalm) {
+	const auto scores = ClassifyOne(kOpenPalm);
+
+	EXPECT_GT(scores.score(Gesture::OPEN_PALM), 0.9f);
+	EXPECT_LT(scores.score(Gesture::POINTING), 0.1f);
+	EXPECT_LT(scores.score(Gesture::PINCH), 0.1f);
+}
+
+TEST(GestureClassifierTest, RecognizesPointing) {
+	const auto scores = ClassifyOne(kPointing);
+
+	EXPECT_GT(scores.score(Gesture::POINTING), 0.9f);
+	EXPECT_LT(scores.score(Gesture::OPEN_PALM), 0.1f);
+	EXPECT_LT(scores.score(Gesture::PINCH), 0.1f);
+}
+
+TEST(GestureClassifierTest, RecognizesPinch) {
+	const auto scores = ClassifyOne(kPinch);
+
+	EXPECT_GT(scores.score(Gesture::PINCH), 0.9f);
+	EXPECT_LT(scores.score(Gesture::POINTING), 0.1f);
+}
+
+TEST(GestureClassifierTest, FistIsNoGesture) {
+	const auto scores = ClassifyOne(kFist);
+
+	for (const auto score : scores.scores)
+		EXPECT_LT(score, 0.1f);
+}
+
+TEST(GestureClassifierTest, IgnoresHandSizeAndPosition) {
+	const auto near = ClassifyOne(kPointing);
+	const auto far = ClassifyOne(MakeHand({ false, true, false, false, false }, false, 0.1f, 0.5f));
+
+	for (int gesture = 0; gesture < kNumGestures; ++gesture)
+		EXPECT_NEAR(near.scores[gesture], far.scores[gesture], 1e-3f) << kGestureNames[gesture];
+}
+
+TEST(GestureClassifierTest, IncompleteHandsScoreZero) {
+	NormalizedLandmarkList partial;
+
+	for (int i = 0; i < 20; ++i)
+		*partial.add_landmark() = kOpenPalm.landmark(i);
+
+	const vector<NormalizedLandmarkList> hands { NormalizedLandmarkList(), partial, kOpenPalm };
+	const auto scores = ClassifyGestures(absl::Span<const NormalizedLandmarkList>(hands));
+
+	ASSERT_EQ(scores.size(), 3u);
+
+	for (int hand = 0; hand < 2; ++hand) {
+		for (const auto score : scores[hand].scores)
+			EXPECT_EQ(score, 0.f) << "hand " << hand;
+	}
+
+	EXPECT_GT(scores[2].score(Gesture::OPEN_PALM), 0.9f);
+}
+
+TEST(GestureClassifierTest, BatchesMatchSingleHands) {
+	const NormalizedLandmarkList *const shapes[] = { &kOpenPalm, &kPointing, &kPinch, &kFist };
+	vector<NormalizedLandmarkList> hands;
+	vector<const NormalizedLandmarkList *> pointers;
+
+	// Several blocks, the last one partial.
+	for (int i = 0; i < 2 * GestureClassifier::kBlockSize + 13; ++i)
+		hands.push_back(*shapes[i % 4]);
+
+	for (const auto &hand : hands)
+		pointers.push_back(&hand);
+
+	GestureClassifier classifier;
+	const auto byValue = classifier.Classify(absl::Span<const NormalizedLandmarkList>(hands));
+	const auto byPointer = classifier.Classify(absl::Span<const NormalizedLandmarkList *const>(pointers));
+
+	ASSERT_EQ(byValue.size(), hands.size());
+	ASSERT_EQ(byPointer.size(), hands.size());
+
+	for (size_t i = 0; i < hands.size(); ++i) {
+		const auto single = ClassifyOne(hands[i]);
+
+		for (int gesture = 0; gesture < kNumGestures; ++gesture) {
+			EXPECT_FLOAT_EQ(byValue[i].scores[gesture], single.scores[gesture]) << "hand " << i;
+			EXPECT_FLOAT_EQ(byPointer[i].scores[gesture], single.scores[gesture]) << "hand " << i;
+		}
+	}
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
@@ -0,0 +1,522 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "benchmark/benchmark.h"
+
+#include "opencv2/imgcodecs/imgcodecs.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+
+#include "mediapipe-solutions/util/latency_histogram.h"
+#include "mediapipe-solutions/util/numa.h"
+
+#include "../gesture/gesture_classifier.h"
+#include "../hands/hands.h"
+#include "../hands/hands_graph.h"
+
+ABSL_FLAG(int, async_threads, 2,
+	"Threads that resume the coroutines in BM_ProcessStreams.");
+ABSL_FLAG(std::string, eval_dir, "",
+	"Directory of .jpg and .png images on which BM_ProcessModel compares the "
+	"landmarks of each model variant with those of the full models.");
+ABSL_FLAG(std::string, image_path, "",
+	"Image fed to the benchmarks. A blank 640x480 frame is used if empty. "
+	"BM_ProcessHandCount tiles it, so it should show exactly one hand.");
+
+using namespace std;
+using namespace std::chrono;
+using namespace mediapipe;
+using namespace mediapipe_solutions;
+
+namespace {
+	const cv::Mat &BenchmarkImage() {
+		static const auto image = []() {
+			const auto image_path = absl::GetFlag(FLAGS_image_path);
+			cv::Mat result;
+
+			if (!image_path.empty()) {
+				cv::cvtColor(cv::imread(image_path), result, cv::COLOR_BGR2RGB);
+			}
+			else {
+				result = cv::Mat::zeros(480, 640, CV_8UC3);
+			}
+
+			return result;
+		}();
+
+		return image;
+	}
+
+	unique_ptr<ImageFrame> ToFrame(const cv::Mat &image) {
+		auto frame = make_unique<ImageFrame>(
+			ImageFormat::SRGB, image.cols, image.rows, ImageFrame::kDefaultAlignmentBoundary);
+
+		image.copyTo(formats::MatView(frame.get()));
+		return frame;
+	}
+
+	const ImageFrame &BenchmarkFrame() {
+		static const auto frame = ToFrame(BenchmarkImage());
+
+		return *frame;
+	}
+
+	// The benchmark image tiled hands times, at most four tiles per row.
+	unique_ptr<ImageFrame> TiledBenchmarkFrame(int hands) {
+		const int columns = min(hands, 4);
+		cv::Mat tiled;
+
+		cv::repeat(BenchmarkImage(), (hands + columns - 1) / columns, columns, tiled);
+		return ToFrame(tiled);
+	}
+
+	unique_ptr<ImageFrame> CopyFrame(const ImageFrame &frame) {
+		auto copy = make_unique<ImageFrame>();
+
+		copy->CopyFrom(frame, ImageFrame::kDefaultAlignmentBoundary);
+		return copy;
+	}
+
+	double MillisecondsSince(steady_clock::time_point start) {
+		return duration<double, milli>(steady_clock::now() - start).count();
+	}
+
+	void BM_ParseAndExpandGraphConfig(benchmark::State &state) {
+		for (auto _ : state)
+			benchmark::DoNotOptimize(CompileHandsGraphConfig());
+	}
+	BENCHMARK(BM_ParseAndExpandGraphConfig)->Unit(benchmark::kMillisecond);
+
+	void BM_ReadPrecompiledGraphConfig(benchmark::State &state) {
+		if (!ReadPrecompiledHandsGraphConfig()) {
+			state.SkipWithError("Precompiled graph not found in the resource directory.");
+			return;
+		}
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(ReadPrecompiledHandsGraphConfig());
+	}
+	BENCHMARK(BM_ReadPrecompiledGraphConfig)->Unit(benchmark::kMillisecond);
+
+	// Time from constructing Hands to the first result. With warm-up enabled the
+	// warm-up runs between construction and the first frame, as it would during
+	// application startup, and is reported separately.
+	void BM_TimeToFirstResult(benchmark::State &state) {
+		const bool warm_up = state.range(0);
+		double construct_ms = 0, warm_up_ms = 0, first_result_ms = 0;
+
+		for (auto _ : state) {
+			auto start = steady_clock::now();
+			Hands hands;
+			const auto construct = MillisecondsSince(start);
+
+			if (warm_up) {
+				start = steady_clock::now();
+				hands.WarmUp(CopyFrame(BenchmarkFrame()));
+				warm_up_ms += MillisecondsSince(start);
+			}
+
+			start = steady_clock::now();
+			benchmark::DoNotOptimize(hands.Process(CopyFrame(BenchmarkFrame())));
+			const auto first_result = MillisecondsSince(start);
+
+			construct_ms += construct;
+			first_result_ms += first_result;
+			state.SetIterationTime((construct + first_result) / 1000.0);
+			hands.Close();
+		}
+
+		state.counters["construct_ms"] = benchmark::Counter(construct_ms, benchmark::Counter::kAvgIterations);
+		state.counters["warm_up_ms"] = benchmark::Counter(warm_up_ms, benchmark::Counter::kAvgIterations);
+		state.counters["first_result_ms"] = benchmark::Counter(first_result_ms, benchmark::Counter::kAvgIterations);
+	}
+	BENCHMARK(BM_TimeToFirstResult)->ArgName("warm_up")->Arg(0)->Arg(1)
+		->UseManualTime()->Unit(benchmark::kMillisecond);
+
+	void BM_Process(benchmark::State &state) {
+		Hands hands;
+
+		hands.WarmUp(CopyFrame(BenchmarkFrame()));
+
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto frame = CopyFrame(BenchmarkFrame());
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(hands.Process(move(frame)));
+		}
+
+		hands.Close();
+	}
+	BENCHMARK(BM_Process)->Unit(benchmark::kMillisecond);
+
+	// Latency over the number of hands in the frame, with the landmark loop
+	// run sequentially (slots = 1) and with one slot per hand.
+	void BM_ProcessHandCount(benchmark::State &state) {
+		const int hands_in_frame = state.range(0);
+		const int slots = state.range(1);
+		const auto tiled = TiledBenchmarkFrame(hands_in_frame);
+		Hands hands(hands_in_frame, 0.5, 0.5, slots);
+
+		hands.WarmUp(CopyFrame(*tiled));
+
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto frame = CopyFrame(*tiled);
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(hands.Process(move(frame)));
+		}
+
+		hands.Close();
+	}
+	BENCHMARK(BM_ProcessHandCount)->ArgNames({ "hands", "slots" })
+		->Args({ 1, 1 })
+		->Args({ 2, 1 })->Args({ 2, 2 })
+		->Args({ 4, 1 })->Args({ 4, 4 })
+		->Args({ 8, 1 })->Args({ 8, 8 })
+		->Unit(benchmark::kMillisecond);
+
+	const vector<cv::Mat> &EvaluationImages() {
+		static const auto images = []() {
+			vector<cv::Mat> result;
+			const auto eval_dir = absl::GetFlag(FLAGS_eval_dir);
+
+			if (eval_dir.empty())
+				return result;
+
+			vector<filesystem::path> paths;
+
+			for (const auto &entry : filesystem::directory_iterator(eval_dir)) {
+				const auto extension = entry.path().extension();
+
+				if (extension == ".jpg" or extension == ".png")
+					paths.push_back(entry.path());
+			}
+
+			// A fixed order, so runs are comparable.
+			sort(paths.begin(), paths.end());
+
+			for (const auto &path : paths) {
+				cv::Mat image;
+
+				cv::cvtColor(cv::imread(path.string()), image, cv::COLOR_BGR2RGB);
+				result.push_back(move(image));
+			}
+
+			return result;
+		}();
+
+		return images;
+	}
+
+	// Landmarks of every evaluation image, each from a fresh graph so that no
+	// tracking state carries over between unrelated images.
+	vector<unordered_map<Handedness, HandNormalizedLandmarkList>> EvaluateModel(HandsModel model) {
+		vector<unordered_map<Handedness, HandNormalizedLandmarkList>> results;
+
+		for (const auto &image : EvaluationImages()) {
+			Hands hands(2, 0.5, 0.5, 1, {}, model);
+
+			results.push_back(hands.Process(ToFrame(image)));
+			hands.Close();
+		}
+
+		return results;
+	}
+
+	struct LandmarkError {
+		// Mean distance to the full model's landmarks in normalized image
+		// coordinates, over hands found by both.
+		double mean;
+		// Hands the full models found and the variant did not.
+		int missed;
+	};
+
+	LandmarkError CompareWithFullModel(HandsModel model) {
+		static const auto reference = EvaluateModel(HandsModel::FULL);
+		const auto results = EvaluateModel(model);
+		LandmarkError error { 0, 0 };
+		int compared = 0;
+
+		for (size_t i = 0; i < reference.size(); ++i) {
+			for (const auto &[handedness, expected] : reference[i]) {
+				const auto actual = results[i].find(handedness);
+
+				if (actual == results[i].end()) {
+					++error.missed;
+					continue;
+				}
+
+				for (int j = 0; j < expected.landmark_size(); ++j) {
+					const auto &a = actual->second.landmark(j);
+					const auto &b = expected.landmark(j);
+
+					error.mean += hypot(a.x() - b.x(), a.y() - b.y());
+					++compared;
+				}
+			}
+		}
+
+		if (compared > 0)
+			error.mean /= compared;
+
+		return error;
+	}
+
+	// Latency of each model variant, and with --eval_dir its landmark error
+	// against the full models. Variants whose files are not installed are
+	// skipped.
+	void BM_ProcessModel(benchmark::State &state) {
+		const auto model = HandsModel(state.range(0));
+		unique_ptr<Hands> hands;
+
+		try {
+			hands = make_unique<Hands>(2, 0.5, 0.5, 1, ExecutionOptions(), model);
+		}
+		catch (const system_error &error) {
+			state.SkipWithError(error.what());
+			return;
+		}
+
+		hands->WarmUp(CopyFrame(BenchmarkFrame()));
+
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto frame = CopyFrame(BenchmarkFrame());
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(hands->Process(move(frame)));
+		}
+
+		hands->Close();
+
+		if (!EvaluationImages().empty()) {
+			const auto error = CompareWithFullModel(model);
+
+			state.counters["landmark_error"] = error.mean;
+			state.counters["hands_missed"] = error.missed;
+		}
+	}
+	BENCHMARK(BM_ProcessModel)->ArgName("model")
+		->Arg(int(HandsModel::FULL))->Arg(int(HandsModel::LITE))->Arg(int(HandsModel::INT8))
+		->Unit(benchmark::kMillisecond);
+
+	enum class Placement {
+		NONE = 0,
+		// Graph threads and frames on node 0.
+		LOCAL = 1,
+		// Graph threads on node 0, frames on the last node.
+		REMOTE = 2,
+	};
+
+	// Latency of one stream depending on where its graph threads and frames
+	// are placed. REMOTE needs more than one NUMA node.
+	void BM_ProcessPlacement(benchmark::State &state) {
+		const auto placement = Placement(state.range(0));
+		const int nodes = NumaNodeCount();
+		ExecutionOptions execution;
+
+		if (placement == Placement::REMOTE and nodes < 2) {
+			state.SkipWithError("Needs more than one NUMA node.");
+			return;
+		}
+
+		if (placement != Placement::NONE)
+			execution.numa_node = 0;
+
+		Hands hands(2, 0.5, 0.5, 1, execution);
+		const auto &source = BenchmarkFrame();
+		const auto frameNode = placement == Placement::REMOTE ? nodes - 1 : 0;
+		LatencyHistogram latency;
+
+		const auto copyFrame = [&]() {
+			if (placement == Placement::NONE)
+				return CopyFrame(source);
+
+			auto frame = placement == Placement::LOCAL
+				? hands.CreateFrame(source.Format(), source.Width(), source.Height())
+				: CreateImageFrameOnNumaNode(source.Format(), source.Width(), source.Height(), frameNode);
+
+			formats::MatView(&source).copyTo(formats::MatView(frame.get()));
+			return frame;
+		};
+
+		hands.WarmUp(copyFrame());
+
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto frame = copyFrame();
+			state.ResumeTiming();
+
+			const auto start = steady_clock::now();
+
+			benchmark::DoNotOptimize(hands.Process(move(frame)));
+			latency.Record(duration_cast<microseconds>(steady_clock::now() - start));
+		}
+
+		state.counters["p50_ms"] = latency.Percentile(50).count() / 1000.0;
+		state.counters["p99_ms"] = latency.Percentile(99).count() / 1000.0;
+		hands.Close();
+	}
+	BENCHMARK(BM_ProcessPlacement)->ArgName("placement")->Arg(0)->Arg(1)->Arg(2)
+		->Unit(benchmark::kMillisecond);
+
+	constexpr int kFramesPerStream = 8;
+
+#if defined(__cpp_impl_coroutine)
+	// Coroutine that starts right away and frees itself when done.
+	struct DetachedTask {
+		struct promise_type {
+			DetachedTask get_return_object() { return {}; }
+			suspend_never initial_suspend() noexcept { return {}; }
+			suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { terminate(); }
+		};
+	};
+
+	DetachedTask ProcessStreamAsync(Hands &hands, Executor &executor, absl::BlockingCounter &done) {
+		for (int i = 0; i < kFramesPerStream; ++i)
+			benchmark::DoNotOptimize(co_await hands.ProcessAsync(CopyFrame(BenchmarkFrame()), &executor));
+
+		done.DecrementCount();
+	}
+#endif
+
+	// Frame throughput of several independent streams, each with its own
+	// Hands. The blocking path runs one thread per stream around Process; the
+	// async path runs one coroutine per stream on --async_threads threads.
+	void BM_ProcessStreams(benchmark::State &state) {
+		const int streams = state.range(0);
+		const bool async = state.range(1);
+		vector<unique_ptr<Hands>> hands;
+
+		for (int i = 0; i < streams; ++i) {
+			hands.push_back(make_unique<Hands>());
+			hands.back()->WarmUp(CopyFrame(BenchmarkFrame()));
+		}
+
+#if defined(__cpp_impl_coroutine)
+		ThreadPoolExecutor executor(absl::GetFlag(FLAGS_async_threads));
+#else
+		if (async) {
+			state.SkipWithError("Built without coroutine support.");
+			return;
+		}
+#endif
+
+		for (auto _ : state) {
+			if (async) {
+#if defined(__cpp_impl_coroutine)
+				absl::BlockingCounter done(streams);
+
+				for (auto &stream : hands)
+					ProcessStreamAsync(*stream, executor, done);
+
+				done.Wait();
+#endif
+			}
+			else {
+				vector<thread> threads;
+
+				for (auto &stream : hands) {
+					threads.emplace_back([&stream]() {
+						for (int i = 0; i < kFramesPerStream; ++i)
+							benchmark::DoNotOptimize(stream->Process(CopyFrame(BenchmarkFrame())));
+					});
+				}
+
+				for (auto &thread : threads)
+					thread.join();
+			}
+		}
+
+		state.counters["frames_per_second"] = benchmark::Counter(
+			double(state.iterations()) * streams * kFramesPerStream, benchmark::Counter::kIsRate);
+		state.counters["caller_threads"] = async ? absl::GetFlag(FLAGS_async_threads) : streams;
+
+		for (auto &stream : hands)
+			stream->Close();
+	}
+	BENCHMARK(BM_ProcessStreams)->ArgNames({ "streams", "async" })
+		->ArgsProduct({ { 1, 4, 16 }, { 0, 1 } })
+		->UseRealTime()->Unit(benchmark::kMillisecond);
+
+	// Hands with random landmarks. The classifier has no branches on the
+	// landmarks, so their values do not change its cost.
+	vector<NormalizedLandmarkList> RandomHands(int count) {
+		mt19937 random(0);
+		uniform_real_distribution<float> coordinate(0.f, 1.f);
+		vector<NormalizedLandmarkList> hands(count);
+
+		for (auto &hand : hands) {
+			for (int i = 0; i < 21; ++i) {
+				auto &landmark = *hand.add_landmark();
+
+				landmark.set_x(coordinate(random));
+				landmark.set_y(coordinate(random));
+				landmark.set_z(coordinate(random) * 0.1f);
+			}
+		}
+
+		return hands;
+	}
+
+	// Gesture scores of many hands, e.g. of all streams of a server, in one
+	// batch or one call per hand.
+	void BM_ClassifyGestures(benchmark::State &state) {
+		const auto hands = RandomHands(state.range(0));
+		const bool batched = state.range(1);
+		GestureClassifier classifier;
+
+		for (auto _ : state) {
+			if (batched) {
+				benchmark::DoNotOptimize(classifier.Classify(hands));
+			}
+			else {
+				for (const auto &hand : hands)
+					benchmark::DoNotOptimize(classifier.Classify(absl::MakeConstSpan(&hand, 1)));
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * hands.size());
+	}
+	BENCHMARK(BM_ClassifyGestures)->ArgNames({ "hands", "batched" })
+		->ArgsProduct({ { 16, 256, 4096 }, { 0, 1 } });
+}
+
+int main(int argc, char **argv) {
+	benchmark::Initialize(&argc, argv);
+	absl::ParseCommandLine(argc, argv);
+	benchmark::RunSpecifiedBenchmarks();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Splits the hand rects of one frame over several copies of the landmark loop
+// and joins their results again, so that the landmark model runs for several
+// hands at once on the graph executor. See UnrollHandLandmarkLoop.
+
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	constexpr char kIterableTag[] = "ITERABLE";
+	constexpr char kRectsTag[] = "RECTS";
+	constexpr char kSlotTag[] = "SLOT";
+}
+
+// Slot i receives rect i; the last slot also receives every rect beyond the
+// number of slots. Every slot gets a vector for every input, possibly empty,
+// so that each per-slot loop still closes its batch.
+//
+// Example config:
+// node {
+//   calculator: "NormalizedRectVectorToSlotsCalculator"
+//   input_stream: "RECTS:hand_rects"
+//   output_stream: "SLOT:0:hand_rects__slot0"
+//   output_stream: "SLOT:1:hand_rects__slot1"
+// }
+class NormalizedRectVectorToSlotsCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			cc->Inputs().Tag(kRectsTag).Set<vector<NormalizedRect>>();
+
+			for (int i = 0; i < cc->Outputs().NumEntries(kSlotTag); ++i)
+				cc->Outputs().Get(kSlotTag, i).Set<vector<NormalizedRect>>();
+
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			if (cc->Inputs().Tag(kRectsTag).IsEmpty())
+				return absl::OkStatus();
+
+			const auto &rects = cc->Inputs().Tag(kRectsTag).Get<vector<NormalizedRect>>();
+			const int slots = cc->Outputs().NumEntries(kSlotTag);
+
+			for (int i = 0; i < slots; ++i) {
+				auto slot = absl::make_unique<vector<NormalizedRect>>();
+
+				if (i < int(rects.size()))
+					slot->assign(rects.begin() + i, i + 1 < slots ? rects.begin() + i + 1 : rects.end());
+
+				cc->Outputs().Get(kSlotTag, i).Add(slot.release(), cc->InputTimestamp());
+			}
+
+			return absl::OkStatus();
+		}
+};
+REGISTER_CALCULATOR(NormalizedRectVectorToSlotsCalculator);
+
+// Concatenates the per-slot results in slot order. Like EndLoopCalculator it
+// emits nothing when no slot produced a result.
+//
+// Example config:
+// node {
+//   calculator: "ConcatenateNormalizedLandmarkListSlotsCalculator"
+//   input_stream: "SLOT:0:multi_hand_landmarks__slot0"
+//   input_stream: "SLOT:1:multi_hand_landmarks__slot1"
+//   output_stream: "ITERABLE:multi_hand_landmarks"
+// }
+template <typename T>
+class ConcatenateSlotsCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			for (int i = 0; i < cc->Inputs().NumEntries(kSlotTag); ++i)
+				cc->Inputs().Get(kSlotTag, i).Set<vector<T>>();
+
+			cc->Outputs().Tag(kIterableTag).Set<vector<T>>();
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			auto concatenated = absl::make_unique<vector<T>>();
+			bool hasResult = false;
+
+			for (int i = 0; i < cc->Inputs().NumEntries(kSlotTag); ++i) {
+				const auto &slot = cc->Inputs().Get(kSlotTag, i);
+
+				if (slot.IsEmpty())
+					continue;
+
+				const auto &items = slot.template Get<vector<T>>();
+
+				concatenated->insert(concatenated->end(), items.begin(), items.end());
+				hasResult = true;
+			}
+
+			if (hasResult)
+				cc->Outputs().Tag(kIterableTag).Add(concatenated.release(), cc->InputTimestamp());
+
+			return absl::OkStatus();
+		}
+};
+
+typedef ConcatenateSlotsCalculator<NormalizedLandmarkList> ConcatenateNormalizedLandmarkListSlotsCalculator;
+REGISTER_CALCULATOR(ConcatenateNormalizedLandmarkListSlotsCalculator);
+
+typedef ConcatenateSlotsCalculator<ClassificationList> ConcatenateClassificationListSlotsCalculator;
+REGISTER_CALCULATOR(ConcatenateClassificationListSlotsCalculator);
+
+typedef ConcatenateSlotsCalculator<NormalizedRect> ConcatenateNormalizedRectSlotsCalculator;
+REGISTER_CALCULATOR(ConcatenateNormalizedRectSlotsCalculator);
+
+}	// namespace mediapipe_solutions
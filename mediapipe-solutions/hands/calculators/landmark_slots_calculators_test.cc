@@ -0,0 +1,123 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+// Rect i has x_center i, so that its position can be told from the outputs.
+vector<NormalizedRect> MakeRects(int first, int count) {
+	vector<NormalizedRect> rects(count);
+
+	for (int i = 0; i < count; ++i)
+		rects[i].set_x_center(float(first + i));
+
+	return rects;
+}
+
+vector<float> Centers(const Packet &packet) {
+	vector<float> centers;
+
+	for (const auto &rect : packet.Get<vector<NormalizedRect>>())
+		centers.push_back(rect.x_center());
+
+	return centers;
+}
+
+CalculatorGraphConfig::Node SlotsNode(int slots) {
+	CalculatorGraphConfig::Node node;
+
+	node.set_calculator("NormalizedRectVectorToSlotsCalculator");
+	node.add_input_stream("RECTS:rects");
+
+	for (int i = 0; i < slots; ++i)
+		node.add_output_stream("SLOT:" + to_string(i) + ":slot" + to_string(i));
+
+	return node;
+}
+
+// The centers every slot received for one frame of count rects.
+vector<vector<float>> SplitIntoSlots(int count, int slots) {
+	CalculatorRunner runner(SlotsNode(slots));
+
+	runner.MutableInputs()->Tag("RECTS").packets.push_back(MakePacket<vector<NormalizedRect>>(MakeRects(0, count)).At(Timestamp(0)));
+
+	if (!runner.Run().ok())
+		return {};
+
+	vector<vector<float>> split;
+
+	for (int i = 0; i < slots; ++i) {
+		const auto &packets = runner.Outputs().Get("SLOT", i).packets;
+
+		EXPECT_EQ(packets.size(), 1u) << "slot " << i;
+
+		if (!packets.empty())
+			split.push_back(Centers(packets.front()));
+	}
+
+	return split;
+}
+
+TEST(LandmarkSlotsCalculatorsTest, LastSlotTakesTheRectsBeyondTheSlots) {
+	EXPECT_EQ(SplitIntoSlots(5, 2), (vector<vector<float>> { { 0 }, { 1, 2, 3, 4 } }));
+	EXPECT_EQ(SplitIntoSlots(3, 3), (vector<vector<float>> { { 0 }, { 1 }, { 2 } }));
+}
+
+TEST(LandmarkSlotsCalculatorsTest, SlotsWithoutRectsGetEmptyVectors) {
+	EXPECT_EQ(SplitIntoSlots(1, 3), (vector<vector<float>> { { 0 }, {}, {} }));
+	EXPECT_EQ(SplitIntoSlots(0, 2), (vector<vector<float>> { {}, {} }));
+}
+
+TEST(LandmarkSlotsCalculatorsTest, ConcatenatesInSlotOrder) {
+	CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+		calculator: "ConcatenateNormalizedRectSlotsCalculator"
+		input_stream: "SLOT:0:slot0"
+		input_stream: "SLOT:1:slot1"
+		input_stream: "SLOT:2:slot2"
+		output_stream: "ITERABLE:rects"
+	)pb"));
+	auto &inputs = *runner.MutableInputs();
+
+	// Frame 0: every slot has a result. Frame 1: the middle slot has none.
+	inputs.Get("SLOT", 0).packets.push_back(MakePacket<vector<NormalizedRect>>(MakeRects(0, 1)).At(Timestamp(0)));
+	inputs.Get("SLOT", 1).packets.push_back(MakePacket<vector<NormalizedRect>>(MakeRects(1, 1)).At(Timestamp(0)));
+	inputs.Get("SLOT", 2).packets.push_back(MakePacket<vector<NormalizedRect>>(MakeRects(2, 2)).At(Timestamp(0)));
+	inputs.Get("SLOT", 0).packets.push_back(MakePacket<vector<NormalizedRect>>(MakeRects(0, 1)).At(Timestamp(1)));
+	inputs.Get("SLOT", 2).packets.push_back(MakePacket<vector<NormalizedRect>>(MakeRects(2, 1)).At(Timestamp(1)));
+
+	ASSERT_TRUE(runner.Run().ok());
+
+	const auto &outputs = runner.Outputs().Tag("ITERABLE").packets;
+
+	ASSERT_EQ(outputs.size(), 2u);
+	EXPECT_EQ(outputs[0].Timestamp(), Timestamp(0));
+	EXPECT_EQ(Centers(outputs[0]), (vector<float> { 0, 1, 2, 3 }));
+	EXPECT_EQ(outputs[1].Timestamp(), Timestamp(1));
+	EXPECT_EQ(Centers(outputs[1]), (vector<float> { 0, 2 }));
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
@@ -0,0 +1,180 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Stream-driven replacements for the side-packet-configured nodes of
+// HandLandmarkTrackingCpu, so that max_num_hands and min_detection_confidence
+// can change on a running graph. Every calculator reads its limit from an
+// input stream that carries one packet per frame.
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	constexpr char kDetectionsTag[] = "DETECTIONS";
+	constexpr char kIterableTag[] = "ITERABLE";
+	constexpr char kMaxNumTag[] = "MAX_NUM";
+	constexpr char kMinScoreTag[] = "MIN_SCORE";
+	constexpr char kMinSizeTag[] = "MIN_SIZE";
+	constexpr char kRectsTag[] = "RECTS";
+}
+
+// Drops detections scoring below MIN_SCORE and keeps at most MAX_NUM of the
+// rest. Replaces ClipDetectionVectorSizeCalculator.
+//
+// Example config:
+// node {
+//   calculator: "FilterDetectionsLiveCalculator"
+//   input_stream: "DETECTIONS:all_palm_detections"
+//   input_stream: "MIN_SCORE:min_detection_confidence"
+//   input_stream: "MAX_NUM:max_num_hands"
+//   output_stream: "DETECTIONS:palm_detections"
+// }
+class FilterDetectionsLiveCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			cc->Inputs().Tag(kDetectionsTag).Set<vector<Detection>>();
+			cc->Inputs().Tag(kMinScoreTag).Set<float>();
+			cc->Inputs().Tag(kMaxNumTag).Set<int>();
+			cc->Outputs().Tag(kDetectionsTag).Set<vector<Detection>>();
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			const auto &detectionsStream = cc->Inputs().Tag(kDetectionsTag);
+
+			if (detectionsStream.IsEmpty())
+				return absl::OkStatus();
+
+			const float minScore = cc->Inputs().Tag(kMinScoreTag).IsEmpty()
+				? 0.0f : cc->Inputs().Tag(kMinScoreTag).Get<float>();
+			const int maxNum = cc->Inputs().Tag(kMaxNumTag).IsEmpty()
+				? numeric_limits<int>::max() : cc->Inputs().Tag(kMaxNumTag).Get<int>();
+
+			auto filtered = absl::make_unique<vector<Detection>>();
+
+			for (const auto &detection : detectionsStream.Get<vector<Detection>>()) {
+				if (int(filtered->size()) >= maxNum)
+					break;
+
+				if (detection.score_size() > 0 and detection.score(0) >= minScore)
+					filtered->push_back(detection);
+			}
+
+			cc->Outputs().Tag(kDetectionsTag).Add(filtered.release(), cc->InputTimestamp());
+			return absl::OkStatus();
+		}
+};
+REGISTER_CALCULATOR(FilterDetectionsLiveCalculator);
+
+// Keeps at most MAX_NUM rects.
+//
+// Example config:
+// node {
+//   calculator: "ClipNormalizedRectVectorSizeLiveCalculator"
+//   input_stream: "RECTS:hand_rects"
+//   input_stream: "MAX_NUM:max_num_hands"
+//   output_stream: "RECTS:clipped_hand_rects"
+// }
+class ClipNormalizedRectVectorSizeLiveCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			cc->Inputs().Tag(kRectsTag).Set<vector<NormalizedRect>>();
+			cc->Inputs().Tag(kMaxNumTag).Set<int>();
+			cc->Outputs().Tag(kRectsTag).Set<vector<NormalizedRect>>();
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			const auto &rectsStream = cc->Inputs().Tag(kRectsTag);
+
+			if (rectsStream.IsEmpty())
+				return absl::OkStatus();
+
+			const auto &rects = rectsStream.Get<vector<NormalizedRect>>();
+			const auto &maxNumStream = cc->Inputs().Tag(kMaxNumTag);
+
+			if (maxNumStream.IsEmpty() or int(rects.size()) <= maxNumStream.Get<int>()) {
+				cc->Outputs().Tag(kRectsTag).AddPacket(rectsStream.Value());
+				return absl::OkStatus();
+			}
+
+			auto clipped = absl::make_unique<vector<NormalizedRect>>(
+				rects.begin(), rects.begin() + max(maxNumStream.Get<int>(), 0));
+
+			cc->Outputs().Tag(kRectsTag).Add(clipped.release(), cc->InputTimestamp());
+			return absl::OkStatus();
+		}
+};
+REGISTER_CALCULATOR(ClipNormalizedRectVectorSizeLiveCalculator);
+
+// Outputs whether ITERABLE holds at least MIN_SIZE rects. Replaces
+// NormalizedRectVectorHasMinSizeCalculator.
+//
+// Example config:
+// node {
+//   calculator: "NormalizedRectVectorHasMinSizeLiveCalculator"
+//   input_stream: "ITERABLE:prev_hand_rects_from_landmarks"
+//   input_stream: "MIN_SIZE:max_num_hands"
+//   output_stream: "prev_has_enough_hands"
+// }
+class NormalizedRectVectorHasMinSizeLiveCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			cc->Inputs().Tag(kIterableTag).Set<vector<NormalizedRect>>();
+			cc->Inputs().Tag(kMinSizeTag).Set<int>();
+			cc->Outputs().Index(0).Set<bool>();
+			return absl::OkStatus();
+		}
+
+		absl::Status Open(CalculatorContext *cc) override {
+			cc->SetOffset(TimestampDiff(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			const auto &iterableStream = cc->Inputs().Tag(kIterableTag);
+			const auto &minSizeStream = cc->Inputs().Tag(kMinSizeTag);
+
+			if (iterableStream.IsEmpty() or minSizeStream.IsEmpty())
+				return absl::OkStatus();
+
+			const bool hasMinSize = int(iterableStream.Get<vector<NormalizedRect>>().size()) >= minSizeStream.Get<int>();
+
+			cc->Outputs().Index(0).AddPacket(MakePacket<bool>(hasMinSize).At(cc->InputTimestamp()));
+			return absl::OkStatus();
+		}
+};
+REGISTER_CALCULATOR(NormalizedRectVectorHasMinSizeLiveCalculator);
+
+}	// namespace mediapipe_solutions
@@ -0,0 +1,156 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+vector<Detection> MakeDetections(const vector<float> &scores) {
+	vector<Detection> detections;
+
+	for (const auto score : scores) {
+		detections.emplace_back();
+
+		if (score >= 0)
+			detections.back().add_score(score);
+	}
+
+	return detections;
+}
+
+vector<float> Scores(const Packet &packet) {
+	vector<float> scores;
+
+	for (const auto &detection : packet.Get<vector<Detection>>())
+		scores.push_back(detection.score(0));
+
+	return scores;
+}
+
+vector<NormalizedRect> MakeRects(int count) {
+	vector<NormalizedRect> rects(count);
+
+	for (int i = 0; i < count; ++i)
+		rects[i].set_x_center(float(i));
+
+	return rects;
+}
+
+template <typename T>
+void Send(CalculatorRunner &runner, const string &tag, T value, int64_t timestamp) {
+	runner.MutableInputs()->Tag(tag).packets.push_back(MakePacket<T>(move(value)).At(Timestamp(timestamp)));
+}
+
+TEST(LiveConfigCalculatorsTest, FilterDetectionsFollowsTheStreams) {
+	CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+		calculator: "FilterDetectionsLiveCalculator"
+		input_stream: "DETECTIONS:detections"
+		input_stream: "MIN_SCORE:min_score"
+		input_stream: "MAX_NUM:max_num"
+		output_stream: "DETECTIONS:filtered"
+	)pb"));
+	const auto detections = MakeDetections({ 0.9f, 0.4f, 0.7f, -1 });
+
+	// Each frame changes one limit. The detection without a score never
+	// passes.
+	const vector<pair<float, int>> limits { { 0.5f, 2 }, { 0.3f, 2 }, { 0.3f, 1 }, { 0.95f, 2 }, { 0.0f, 4 } };
+
+	for (size_t i = 0; i < limits.size(); ++i) {
+		Send(runner, "DETECTIONS", detections, i);
+		Send(runner, "MIN_SCORE", limits[i].first, i);
+		Send(runner, "MAX_NUM", limits[i].second, i);
+	}
+
+	ASSERT_TRUE(runner.Run().ok());
+
+	const auto &outputs = runner.Outputs().Tag("DETECTIONS").packets;
+
+	ASSERT_EQ(outputs.size(), limits.size());
+	EXPECT_EQ(Scores(outputs[0]), (vector<float> { 0.9f, 0.7f }));
+	EXPECT_EQ(Scores(outputs[1]), (vector<float> { 0.9f, 0.4f }));
+	EXPECT_EQ(Scores(outputs[2]), (vector<float> { 0.9f }));
+	EXPECT_TRUE(Scores(outputs[3]).empty());
+	EXPECT_EQ(Scores(outputs[4]), (vector<float> { 0.9f, 0.4f, 0.7f }));
+}
+
+TEST(LiveConfigCalculatorsTest, ClipRectsFollowsMaxNum) {
+	CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+		calculator: "ClipNormalizedRectVectorSizeLiveCalculator"
+		input_stream: "RECTS:rects"
+		input_stream: "MAX_NUM:max_num"
+		output_stream: "RECTS:clipped"
+	)pb"));
+	const vector<int> maxNums { 2, 5, 3, 0, -1 };
+
+	for (size_t i = 0; i < maxNums.size(); ++i) {
+		Send(runner, "RECTS", MakeRects(3), i);
+		Send(runner, "MAX_NUM", maxNums[i], i);
+	}
+
+	ASSERT_TRUE(runner.Run().ok());
+
+	const auto &outputs = runner.Outputs().Tag("RECTS").packets;
+	const vector<size_t> expected { 2, 3, 3, 0, 0 };
+
+	ASSERT_EQ(outputs.size(), expected.size());
+
+	for (size_t i = 0; i < expected.size(); ++i) {
+		const auto &rects = outputs[i].Get<vector<NormalizedRect>>();
+
+		ASSERT_EQ(rects.size(), expected[i]) << "frame " << i;
+
+		// Keeps the first rects, in order.
+		for (size_t j = 0; j < rects.size(); ++j)
+			EXPECT_EQ(rects[j].x_center(), float(j));
+	}
+}
+
+TEST(LiveConfigCalculatorsTest, HasMinSizeFollowsMinSize) {
+	CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+		calculator: "NormalizedRectVectorHasMinSizeLiveCalculator"
+		input_stream: "ITERABLE:rects"
+		input_stream: "MIN_SIZE:min_size"
+		output_stream: "has_min_size"
+	)pb"));
+	const vector<int> minSizes { 2, 3, 1, 0 };
+
+	for (size_t i = 0; i < minSizes.size(); ++i) {
+		Send(runner, "ITERABLE", MakeRects(2), i);
+		Send(runner, "MIN_SIZE", minSizes[i], i);
+	}
+
+	ASSERT_TRUE(runner.Run().ok());
+
+	const auto &outputs = runner.Outputs().Index(0).packets;
+
+	ASSERT_EQ(outputs.size(), minSizes.size());
+	EXPECT_TRUE(outputs[0].Get<bool>());
+	EXPECT_FALSE(outputs[1].Get<bool>());
+	EXPECT_TRUE(outputs[2].Get<bool>());
+	EXPECT_TRUE(outputs[3].Get<bool>());
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
@@ -13,10 +13,13 @@
 // limitations under the License.
 
 #include "hands.h"
+#include "hands_graph.h"
 
+#include <algorithm>
 #include <string_view>
 
 #include "mediapipe/calculators/core/constant_side_packet_calculator.pb.h"
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
 
 #include "mediapipe/framework/deps/file_helpers.h"
 #include "mediapipe/framework/formats/classification.pb.h"
@@ -33,6 +36,27 @@ namespace {
 		side_inputs.emplace("num_hands", max_num_hands);
 		return side_inputs;
 	}
+
+	CalculatorGraphConfig CreateGraphConfig(int landmark_slots, HandsModel model, bool classify_gestures) {
+		auto config = LoadHandsGraphConfig();
+
+		SelectHandsModel(config, model);
+		UnrollHandLandmarkLoop(config, landmark_slots);
+
+		if (classify_gestures)
+			AddHandGestureClassifier(config);
+
+		return config;
+	}
+
+	vector<string> CreateOutputs(bool classify_gestures) {
+		vector<string> outputs { "landmarks", "handedness" };
+
+		if (classify_gestures)
+			outputs.push_back(kHandGesturesStream);
+
+		return outputs;
+	}
 	
 	/*
 	google::protobuf::Message *CreateConstantSidePacket(bool value) {
@@ -78,62 +102,112 @@ Hands::Hands(
 Hands::Hands(
 		//bool static_image_mode,
 		int max_num_hands,
-		float min_detection_confidence, double min_tracking_confidence
+		float min_detection_confidence, double min_tracking_confidence,
+		int landmark_slots,
+		ExecutionOptions execution,
+		HandsModel model,
+		bool classify_gestures
 	)
 	: SolutionBase(
-		string(
-		"input_stream: \"input_video\""
-		"output_stream: \"landmarks\""
-		"node {"
-		"calculator: \"HandLandmarkTrackingCpu\""
-		"input_stream: \"IMAGE:input_video\""
-		"input_side_packet: \"NUM_HANDS:num_hands\""
-		"output_stream: \"LANDMARKS:landmarks\""
-		"output_stream: \"HANDEDNESS:handedness\""
-		"output_stream: \"PALM_DETECTIONS:multi_palm_detections\""
-		"output_stream: \"HAND_ROIS_FROM_LANDMARKS:multi_hand_rects\""
-		"output_stream: \"HAND_ROIS_FROM_PALM_DETECTIONS:multi_palm_rects\""
-		"}"),
+		CreateGraphConfig(landmark_slots, model, classify_gestures),
 		CreateSideInputs(max_num_hands),					// side_inputs
-		{ { string("landmarks"), string("handedness") } },	// outputs
+		CreateOutputs(classify_gestures),					// outputs
 		{
 			//{
 			//	"handlandmarktrackingcpu__ConstantSidePacketCalculator.packet",
 			//	CreateConstantSidePacket(!static_image_mode)
 			//},
-			{
-				"handlandmarktrackingcpu__palmdetectioncpu__TensorsToDetectionsCalculator.min_score_thresh",
-				min_detection_confidence
-			},
-			{
-				"handlandmarktrackingcpu__handlandmarkcpu__ThresholdingCalculator.threshold",
-				min_tracking_confidence
-			}
-		}
-	) {
+			CalculatorOption::Set(
+				"handlandmarktrackingcpu__palmdetectioncpu__TensorsToDetectionsCalculator",
+				&TensorsToDetectionsCalculatorOptions::set_min_score_thresh,
+				min(min_detection_confidence, kMinDetectionConfidenceFloor)
+			)
+		},
+		move(execution)
+	),
+	max_num_hands_(max_num_hands),
+	min_detection_confidence_(min_detection_confidence),
+	min_tracking_confidence_(min_tracking_confidence) {
+}
+
+unordered_map<Handedness, HandNormalizedLandmarkList> Hands::Process(unique_ptr<ImageFrame> image, Deadline deadline) {
+	return ToHands(SolutionBase::Process(CreateInputs(move(image)), deadline));
 }
 
-unordered_map<Handedness, HandNormalizedLandmarkList> Hands::Process(unique_ptr<ImageFrame> image) {
+vector<pair<Handedness, HandNormalizedLandmarkList>> Hands::ProcessAllHands(unique_ptr<ImageFrame> image, Deadline deadline) {
+	return ToHandList(SolutionBase::Process(CreateInputs(move(image)), deadline));
+}
+
+unordered_map<Handedness, HandNormalizedLandmarkList> Hands::ToHands(unordered_map<string, Any> &&output) {
 	unordered_map<Handedness, HandNormalizedLandmarkList> processed;
-	
-	auto output = SolutionBase::Process("input_video", Any::Adopt(move(image)));
+
+	for (auto &hand : ToHandList(move(output)))
+		processed.emplace(hand.first, move(hand.second));
+
+	return processed;
+}
+
+vector<pair<Handedness, HandNormalizedLandmarkList>> Hands::ToHandList(unordered_map<string, Any> &&output) {
+	vector<pair<Handedness, HandNormalizedLandmarkList>> processed;
 	
 	if (output.count("landmarks") and output.count("handedness")) {
 		auto landmarkLists = move(output.at("landmarks")).Get<vector<NormalizedLandmarkList>>();
 		auto handednessLists = move(output.at("handedness")).Get<vector<ClassificationList>>();
 		
+		vector<ClassificationList> gestureLists;
+
 		if (landmarkLists.size() != handednessLists.size())
 			throw logic_error("Failed to match landmarks with hand.");
+
+		if (output.count(kHandGesturesStream)) {
+			gestureLists = move(output.at(kHandGesturesStream)).Get<vector<ClassificationList>>();
+
+			if (gestureLists.size() != landmarkLists.size())
+				throw logic_error("Failed to match gestures with hand.");
+		}
 		
 		for (size_t i = 0; i < handednessLists.size(); ++i) {
-			processed.emplace(
-				Handedness(handednessLists.at(i).classification().at(0).index()),
-				move(landmarkLists.at(i))
-			);
+			HandNormalizedLandmarkList hand(move(landmarkLists.at(i)));
+
+			if (!gestureLists.empty()) {
+				for (const auto &gesture : gestureLists.at(i).classification())
+					hand.gestures_.scores.at(gesture.index()) = gesture.score();
+			}
+
+			processed.emplace_back(Handedness(handednessLists.at(i).classification().at(0).index()), move(hand));
 		}
 	}
 	
 	return processed;
 }
 
+void Hands::WarmUp(unique_ptr<ImageFrame> sample) {
+	if (!sample)
+		sample = CreateFrame(ImageFormat::SRGB, 256, 256);
+
+	SolutionBase::Process(CreateInputs(move(sample)));
+}
+
+void Hands::SetMaxNumHands(int max_num_hands) {
+	max_num_hands_ = max_num_hands;
+}
+
+void Hands::SetMinDetectionConfidence(float min_detection_confidence) {
+	min_detection_confidence_ = min_detection_confidence;
+}
+
+void Hands::SetMinTrackingConfidence(double min_tracking_confidence) {
+	min_tracking_confidence_ = min_tracking_confidence;
+}
+
+unordered_map<string_view, Any> Hands::CreateInputs(unique_ptr<ImageFrame> image) const {
+	unordered_map<string_view, Any> inputs;
+
+	inputs.emplace("input_video", Any::Adopt(move(image)));
+	inputs.emplace(kMaxNumHandsStream, max_num_hands_.load());
+	inputs.emplace(kMinDetectionConfidenceStream, min_detection_confidence_.load());
+	inputs.emplace(kMinTrackingConfidenceStream, min_tracking_confidence_.load());
+	return inputs;
+}
+
 }
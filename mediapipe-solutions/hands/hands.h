@@ -15,7 +15,14 @@
 #ifndef MEDIAPIPE_SOLUTIONS_SOLUTIONS_HANDS_H_
 #define MEDIAPIPE_SOLUTIONS_SOLUTIONS_HANDS_H_
 
+#include <atomic>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "../solution_base.h"
+#include "../gesture/gesture_classifier.h"
+#include "hands_graph.h"
 
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
@@ -59,6 +66,13 @@ class HandNormalizedLandmarkList : public mediapipe::NormalizedLandmarkList {
 		const mediapipe::NormalizedLandmark &landmark(HandLandmark handLandmark) const;
 
 		using mediapipe::NormalizedLandmarkList::landmark;
+
+		// All 0 unless Hands was constructed with classify_gestures.
+		const GestureScores &gestures() const;
+	private:
+		friend class Hands;
+
+		GestureScores gestures_;
 };
 
 class Hands : public SolutionBase {
@@ -68,14 +82,83 @@ class Hands : public SolutionBase {
 			float min_detection_confidence = 0.5, double min_tracking_confidence = 0.5
 		);*/
 
+		// With landmark_slots > 1 the landmark model runs for up to that many
+		// hands concurrently, one interpreter per slot, instead of one hand after
+		// the other. See UnrollHandLandmarkLoop. With classify_gestures every
+		// hand's gestures() are scored in the graph; see AddHandGestureClassifier.
 		Hands(
 			int max_num_hands = 2,
-			float min_detection_confidence = 0.5, double min_tracking_confidence = 0.5
+			float min_detection_confidence = 0.5, double min_tracking_confidence = 0.5,
+			int landmark_slots = 1,
+			ExecutionOptions execution = {},
+			HandsModel model = HandsModel::FULL,
+			bool classify_gestures = false
+		);
+
+		// Throws std::system_error with std::errc::timed_out if the result is
+		// not ready by deadline. A late frame is dropped at the next deadline
+		// gate rather than finishing in the background.
+		std::unordered_map<Handedness, HandNormalizedLandmarkList> Process(
+			std::unique_ptr<mediapipe::ImageFrame> image, Deadline deadline = std::nullopt
+		);
+
+		// Like Process, but returns every hand in the order of the graph. Process
+		// keeps only the first hand of each handedness, which loses hands once
+		// max_num_hands is above 2.
+		std::vector<std::pair<Handedness, HandNormalizedLandmarkList>> ProcessAllHands(
+			std::unique_ptr<mediapipe::ImageFrame> image, Deadline deadline = std::nullopt
 		);
 
-		std::unordered_map<Handedness, HandNormalizedLandmarkList> Process(std::unique_ptr<mediapipe::ImageFrame> image);
+#if defined(__cpp_impl_coroutine)
+		// co_await hands.ProcessAsync(std::move(image), &executor) yields the
+		// same result as Process without blocking the calling thread. See
+		// ProcessAwaitable for where the coroutine resumes.
+		ProcessAwaitable<std::unordered_map<Handedness, HandNormalizedLandmarkList>> ProcessAsync(
+			std::unique_ptr<mediapipe::ImageFrame> image, mediapipe::Executor *executor = nullptr,
+			Deadline deadline = std::nullopt
+		);
+#endif
+
+		// Runs one frame through the graph and discards the result, so that the
+		// inference interpreters are allocated before the first real frame. The
+		// landmark model is only primed if sample contains a hand; a blank frame
+		// is used when no sample is given.
+		void WarmUp(std::unique_ptr<mediapipe::ImageFrame> sample = nullptr);
+
+		// Take effect with the next frame without restarting the graph, so
+		// tracking state is kept. May be called from any thread. Detection
+		// confidences below kMinDetectionConfidenceFloor act as the floor.
+		void SetMaxNumHands(int max_num_hands);
+		void SetMinDetectionConfidence(float min_detection_confidence);
+		void SetMinTrackingConfidence(double min_tracking_confidence);
+
+		// Pairs the landmarks, handedness and, if present, gesture outputs of a
+		// hands graph.
+		static std::unordered_map<Handedness, HandNormalizedLandmarkList> ToHands(
+			std::unordered_map<std::string, Any> &&output
+		);
+		static std::vector<std::pair<Handedness, HandNormalizedLandmarkList>> ToHandList(
+			std::unordered_map<std::string, Any> &&output
+		);
+	private:
+		std::atomic<int> max_num_hands_;
+		std::atomic<float> min_detection_confidence_;
+		std::atomic<double> min_tracking_confidence_;
+
+		std::unordered_map<std::string_view, Any> CreateInputs(std::unique_ptr<mediapipe::ImageFrame> image) const;
 };
 
+#if defined(__cpp_impl_coroutine)
+// Inline, so that only code built as C++20 needs coroutine support.
+inline ProcessAwaitable<std::unordered_map<Handedness, HandNormalizedLandmarkList>> Hands::ProcessAsync(
+	std::unique_ptr<mediapipe::ImageFrame> image, mediapipe::Executor *executor, Deadline deadline
+) {
+	return ProcessAwaitable<std::unordered_map<Handedness, HandNormalizedLandmarkList>>(
+		*this, CreateInputs(std::move(image)), executor, &Hands::ToHands, deadline
+	);
+}
+#endif
+
 inline HandNormalizedLandmarkList::HandNormalizedLandmarkList(const mediapipe::NormalizedLandmarkList &other) : NormalizedLandmarkList(other) {
 }
 
@@ -86,6 +169,10 @@ inline const mediapipe::NormalizedLandmark &HandNormalizedLandmarkList::landmark
 	return landmark(int(handLandmark));
 }
 
+inline const GestureScores &HandNormalizedLandmarkList::gestures() const {
+	return gestures_;
+}
+
 }
 
 #endif // MEDIAPIPE_SOLUTIONS_SOLUTIONS_HANDS_H_
@@ -0,0 +1,385 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hands_graph.h"
+
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/tool/validate_name.h"
+#include "mediapipe/util/resource_util.h"
+
+#include "mediapipe-solutions/deadline.h"
+#include "mediapipe-solutions/util/util.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	constexpr char kHandsGraph[] =
+		"input_stream: \"input_video\""
+		"output_stream: \"landmarks\""
+		"node {"
+		"calculator: \"HandLandmarkTrackingCpu\""
+		"input_stream: \"IMAGE:input_video\""
+		"input_side_packet: \"NUM_HANDS:num_hands\""
+		"output_stream: \"LANDMARKS:landmarks\""
+		"output_stream: \"HANDEDNESS:handedness\""
+		"output_stream: \"PALM_DETECTIONS:multi_palm_detections\""
+		"output_stream: \"HAND_ROIS_FROM_LANDMARKS:multi_hand_rects\""
+		"output_stream: \"HAND_ROIS_FROM_PALM_DETECTIONS:multi_palm_rects\""
+		"}";
+
+	constexpr char kLoopMinTrackingConfidenceStream[] = "hands_loop_min_tracking_confidence";
+
+	struct TagIndexName {
+		string tag;
+		int index;
+		string name;
+	};
+
+	TagIndexName ParseStream(const string &stream) {
+		TagIndexName parsed;
+
+		ThrowIfNotOk(tool::ParseTagIndexName(stream, &parsed.tag, &parsed.index, &parsed.name));
+		return parsed;
+	}
+
+	CalculatorGraphConfig::Node &FindNode(CalculatorGraphConfig &config, const string &calculator) {
+		for (auto &node : *config.mutable_node()) {
+			if (node.calculator() == calculator)
+				return node;
+		}
+
+		throw out_of_range("The hands graph has no " + calculator + " node.");
+	}
+
+	int FindStream(const google::protobuf::RepeatedPtrField<string> &streams, const string &tag) {
+		for (int i = 0; i < streams.size(); ++i) {
+			if (ParseStream(streams.Get(i)).tag == tag)
+				return i;
+		}
+
+		throw out_of_range("No " + tag + " stream found.");
+	}
+
+	// Replaces the nodes of HandLandmarkTrackingCpu that read num_hands or a
+	// confidence threshold once at startup with nodes that read them from the
+	// graph input streams, one packet per frame.
+	void EnableLiveConfig(CalculatorGraphConfig &config) {
+		config.add_input_stream(kMaxNumHandsStream);
+		config.add_input_stream(kMinDetectionConfidenceStream);
+		config.add_input_stream(kMinTrackingConfidenceStream);
+
+		// Palm detections are filtered by the live score threshold after
+		// TensorsToDetectionsCalculator, which keeps a static lower bound.
+		{
+			auto &node = FindNode(config, "ClipDetectionVectorSizeCalculator");
+			const auto input = ParseStream(node.input_stream(0)).name;
+			const auto output = ParseStream(node.output_stream(0)).name;
+
+			node.set_calculator("FilterDetectionsLiveCalculator");
+			node.clear_input_stream();
+			node.clear_output_stream();
+			node.clear_input_side_packet();
+			node.clear_options();
+			node.add_input_stream("DETECTIONS:" + input);
+			node.add_input_stream("MIN_SCORE:"s + kMinDetectionConfidenceStream);
+			node.add_input_stream("MAX_NUM:"s + kMaxNumHandsStream);
+			node.add_output_stream("DETECTIONS:" + output);
+		}
+
+		// Palm detection is skipped while enough hands are tracked.
+		{
+			auto &node = FindNode(config, "NormalizedRectVectorHasMinSizeCalculator");
+			const auto iterable = ParseStream(node.input_stream(FindStream(node.input_stream(), "ITERABLE"))).name;
+
+			node.set_calculator("NormalizedRectVectorHasMinSizeLiveCalculator");
+			node.clear_input_stream();
+			node.clear_input_side_packet();
+			node.clear_options();
+			node.add_input_stream("ITERABLE:" + iterable);
+			node.add_input_stream("MIN_SIZE:"s + kMaxNumHandsStream);
+		}
+
+		// Tracked hands beyond the live maximum are dropped before landmark
+		// inference, and the tracking threshold is cloned into every loop
+		// iteration for ThresholdingCalculator.
+		{
+			auto &begin = FindNode(config, "BeginLoopNormalizedRectCalculator");
+			const int iterableIndex = FindStream(begin.input_stream(), "ITERABLE");
+			const auto iterable = ParseStream(begin.input_stream(iterableIndex)).name;
+			const auto clipped = iterable + "_live_clipped";
+			int clones = 0;
+
+			for (const auto &stream : begin.input_stream()) {
+				if (ParseStream(stream).tag == "CLONE")
+					++clones;
+			}
+
+			begin.set_input_stream(iterableIndex, "ITERABLE:" + clipped);
+			begin.add_input_stream("CLONE:" + to_string(clones) + ":" + kMinTrackingConfidenceStream);
+			begin.add_output_stream("CLONE:" + to_string(clones) + ":" + kLoopMinTrackingConfidenceStream);
+
+			auto &clip = *config.add_node();
+
+			clip.set_name(begin.name() + "__ClipNormalizedRectVectorSizeLiveCalculator");
+			clip.set_calculator("ClipNormalizedRectVectorSizeLiveCalculator");
+			clip.add_input_stream("RECTS:" + iterable);
+			clip.add_input_stream("MAX_NUM:"s + kMaxNumHandsStream);
+			clip.add_output_stream("RECTS:" + clipped);
+		}
+
+		// ThresholdingCalculator refuses a threshold option next to the stream.
+		{
+			auto &node = FindNode(config, "ThresholdingCalculator");
+
+			node.clear_options();
+			node.add_input_stream("THRESHOLD:"s + kLoopMinTrackingConfidenceStream);
+		}
+	}
+}
+
+void UnrollHandLandmarkLoop(CalculatorGraphConfig &config, int slots) {
+	static const map<string, string> concatenateCalculators = {
+		{ "EndLoopNormalizedLandmarkListVectorCalculator", "ConcatenateNormalizedLandmarkListSlotsCalculator" },
+		{ "EndLoopClassificationListCalculator", "ConcatenateClassificationListSlotsCalculator" },
+		{ "EndLoopNormalizedRectCalculator", "ConcatenateNormalizedRectSlotsCalculator" },
+	};
+
+	if (slots <= 1)
+		return;
+
+	const auto &begin = FindNode(config, "BeginLoopNormalizedRectCalculator");
+	const auto iterable = ParseStream(begin.input_stream(FindStream(begin.input_stream(), "ITERABLE"))).name;
+
+	// Streams that live inside the loop, starting with what BeginLoop emits.
+	// Every node consuming one of them belongs to the loop; EndLoop nodes,
+	// recognized by their BATCH_END input, close it.
+	set<string> loopStreams;
+	set<const CalculatorGraphConfig::Node *> loopNodes { &begin };
+	vector<const CalculatorGraphConfig::Node *> bodyNodes, endNodes;
+
+	for (const auto &stream : begin.output_stream())
+		loopStreams.insert(ParseStream(stream).name);
+
+	for (bool changed = true; changed;) {
+		changed = false;
+
+		for (const auto &node : config.node()) {
+			if (loopNodes.count(&node))
+				continue;
+
+			bool inLoop = false, isEnd = false;
+
+			for (const auto &stream : node.input_stream()) {
+				const auto parsed = ParseStream(stream);
+
+				inLoop |= loopStreams.count(parsed.name) > 0;
+				isEnd |= parsed.tag == "BATCH_END";
+			}
+
+			if (!inLoop)
+				continue;
+
+			loopNodes.insert(&node);
+			changed = true;
+
+			if (isEnd) {
+				endNodes.push_back(&node);
+			}
+			else {
+				bodyNodes.push_back(&node);
+
+				for (const auto &stream : node.output_stream())
+					loopStreams.insert(ParseStream(stream).name);
+			}
+		}
+	}
+
+	// The EndLoop outputs are renamed per slot and joined again below.
+	auto renamedStreams = loopStreams;
+
+	for (const auto *end : endNodes)
+		renamedStreams.insert(ParseStream(end->output_stream(FindStream(end->output_stream(), "ITERABLE"))).name);
+
+	const auto rename = [&renamedStreams](const string &stream, const string &suffix) {
+		return renamedStreams.count(ParseStream(stream).name) ? stream + suffix : stream;
+	};
+
+	vector<CalculatorGraphConfig::Node> nodes;
+
+	for (const auto &node : config.node()) {
+		if (!loopNodes.count(&node))
+			nodes.push_back(node);
+	}
+
+	CalculatorGraphConfig::Node slicer;
+
+	slicer.set_name(begin.name() + "__NormalizedRectVectorToSlotsCalculator");
+	slicer.set_calculator("NormalizedRectVectorToSlotsCalculator");
+	slicer.add_input_stream("RECTS:" + iterable);
+
+	vector<const CalculatorGraphConfig::Node *> slotNodes { &begin };
+
+	slotNodes.insert(slotNodes.end(), bodyNodes.begin(), bodyNodes.end());
+	slotNodes.insert(slotNodes.end(), endNodes.begin(), endNodes.end());
+
+	for (int slot = 0; slot < slots; ++slot) {
+		const auto suffix = "__slot" + to_string(slot);
+
+		slicer.add_output_stream("SLOT:" + to_string(slot) + ":" + iterable + suffix);
+
+		for (const auto *original : slotNodes) {
+			auto copy = *original;
+
+			copy.set_name(original->name() + suffix);
+
+			for (auto &stream : *copy.mutable_input_stream())
+				stream = rename(stream, suffix);
+
+			for (auto &stream : *copy.mutable_output_stream())
+				stream = rename(stream, suffix);
+
+			if (original == &begin)
+				copy.set_input_stream(FindStream(copy.input_stream(), "ITERABLE"), "ITERABLE:" + iterable + suffix);
+
+			nodes.push_back(move(copy));
+		}
+	}
+
+	nodes.push_back(move(slicer));
+
+	for (const auto *end : endNodes) {
+		const auto calculator = concatenateCalculators.find(end->calculator());
+
+		if (calculator == concatenateCalculators.end())
+			throw out_of_range("Cannot join the results of " + end->calculator() + ".");
+
+		const auto output = ParseStream(end->output_stream(FindStream(end->output_stream(), "ITERABLE"))).name;
+		CalculatorGraphConfig::Node concatenate;
+
+		concatenate.set_name(end->name() + "__" + calculator->second);
+		concatenate.set_calculator(calculator->second);
+
+		for (int slot = 0; slot < slots; ++slot)
+			concatenate.add_input_stream("SLOT:" + to_string(slot) + ":" + output + "__slot" + to_string(slot));
+
+		concatenate.add_output_stream("ITERABLE:" + output);
+		nodes.push_back(move(concatenate));
+	}
+
+	config.clear_node();
+
+	for (auto &node : nodes)
+		*config.add_node() = move(node);
+}
+
+void SelectHandsModel(CalculatorGraphConfig &config, HandsModel model) {
+	if (model == HandsModel::FULL)
+		return;
+
+	const string suffix = model == HandsModel::LITE ? "_lite" : "_int8";
+	int selected = 0;
+
+	// Matches by model file rather than node name, which differs once the
+	// landmark loop is unrolled.
+	for (auto &node : *config.mutable_node()) {
+		if (node.calculator().rfind("InferenceCalculator", 0) != 0
+			or !node.options().HasExtension(InferenceCalculatorOptions::ext))
+			continue;
+
+		auto &options = *node.mutable_options()->MutableExtension(InferenceCalculatorOptions::ext);
+		const auto &path = options.model_path();
+		const auto name = path.substr(path.rfind('/') + 1);
+
+		if (name != "palm_detection.tflite" and name != "hand_landmark.tflite")
+			continue;
+
+		const auto variant = string(kHandsModelDirectory) + "/" + name.substr(0, name.rfind('.')) + suffix + ".tflite";
+		const auto resolved = PathToResourceAsFile(variant);
+
+		// The variants are not part of the repository, so say where they go.
+		if (!resolved.ok() or !file::Exists(*resolved).ok())
+			throw system_error(
+				make_error_code(errc::no_such_file_or_directory),
+				"Model " + variant + " is not installed. Put palm_detection" + suffix + ".tflite and hand_landmark"
+					+ suffix + ".tflite into " + kHandsModelDirectory + "/ under the resource directory "
+					"(resource_root_dir) or the hands target's runfiles."
+			);
+
+		options.set_model_path(variant);
+		++selected;
+	}
+
+	if (selected == 0)
+		throw out_of_range("The hands graph has no inference node to select a model for.");
+}
+
+void AddHandGestureClassifier(CalculatorGraphConfig &config) {
+	auto &node = *config.add_node();
+
+	node.set_name("HandGestureCalculator");
+	node.set_calculator("HandGestureCalculator");
+	node.add_input_stream("LANDMARKS:landmarks");
+	node.add_output_stream("GESTURES:"s + kHandGesturesStream);
+	config.add_output_stream(kHandGesturesStream);
+}
+
+CalculatorGraphConfig CompileHandsGraphConfig() {
+	auto config = ExpandGraphConfig(ParseTextProtoOrDie<CalculatorGraphConfig>(string(kHandsGraph)));
+
+	EnableLiveConfig(config);
+
+	// Late frames are dropped on arrival and again before landmark inference,
+	// the most expensive stage. The live parameters are dropped with the
+	// frame, since BeginLoop clones the tracking threshold and would otherwise
+	// let the second gate see the frame again.
+	AddDeadlineGate(
+		config,
+		{ "input_video", kMaxNumHandsStream, kMinDetectionConfidenceStream, kMinTrackingConfidenceStream },
+		"input_deadline"
+	);
+	AddDeadlineGate(config, FindNode(config, "BeginLoopNormalizedRectCalculator"), "hand_landmark_deadline");
+
+	// Validates the rewritten graph, so a mismatch with the upstream subgraphs
+	// already fails when the graph is precompiled.
+	return ExpandGraphConfig(config);
+}
+
+optional<CalculatorGraphConfig> ReadPrecompiledHandsGraphConfig() {
+	auto path = PathToResourceAsFile(kPrecompiledHandsGraphPath);
+
+	if (!path.ok() or !file::Exists(*path).ok())
+		return nullopt;
+
+	return ReadCalculatorGraphConfigFromFile(*path);
+}
+
+CalculatorGraphConfig LoadHandsGraphConfig() {
+	if (auto precompiled = ReadPrecompiledHandsGraphConfig())
+		return move(*precompiled);
+
+	return CompileHandsGraphConfig();
+}
+
+}
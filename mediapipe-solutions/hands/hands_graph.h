@@ -0,0 +1,84 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_HANDS_HANDS_GRAPH_H_
+#define MEDIAPIPE_SOLUTIONS_HANDS_HANDS_GRAPH_H_
+
+#include <optional>
+
+#include "mediapipe/framework/calculator.pb.h"
+
+namespace mediapipe_solutions {
+
+// Resource path of the binary graph emitted by hands-graph-compiler.
+constexpr char kPrecompiledHandsGraphPath[] = "mediapipe-solutions/hands/hands_graph.binarypb";
+
+// Input streams that carry the runtime-adjustable parameters. Each needs one
+// packet per frame: int, float and double respectively.
+constexpr char kMaxNumHandsStream[] = "max_num_hands";
+constexpr char kMinDetectionConfidenceStream[] = "min_detection_confidence";
+constexpr char kMinTrackingConfidenceStream[] = "min_tracking_confidence";
+
+// Model files of the palm detector and the hand landmark model. FULL are the
+// models MediaPipe ships. The others are looked up in the resource directory
+// under kHandsModelDirectory and must keep the input and output tensors of
+// the FULL models.
+enum class HandsModel {
+	FULL = 0,
+	LITE = 1,
+	// Weights and activations quantized to int8.
+	INT8 = 2,
+};
+
+constexpr char kHandsModelDirectory[] = "mediapipe-solutions/hands/models";
+
+// Output stream added by AddHandGestureClassifier, with a
+// std::vector<ClassificationList> of gesture scores, one per hand.
+constexpr char kHandGesturesStream[] = "hand_gestures";
+
+// Palm detection keeps this static score threshold, so the live
+// min_detection_confidence can not go below it.
+constexpr float kMinDetectionConfidenceFloor = 0.1f;
+
+// Parses the text graph, expands its subgraphs and rewires num_hands and the
+// confidence thresholds to the input streams above. Also adds the deadline
+// gates "input_deadline" and "hand_landmark_deadline". This is what
+// hands-graph-compiler serializes at build time.
+mediapipe::CalculatorGraphConfig CompileHandsGraphConfig();
+
+// Replaces the sequential per-hand landmark loop by slots copies of it. Hand i
+// goes to slot i and the last slot takes any remaining hands, so the copies
+// run concurrently on the graph executor, each with its own interpreter. The
+// results are concatenated in hand order again. Does nothing for slots <= 1.
+void UnrollHandLandmarkLoop(mediapipe::CalculatorGraphConfig &config, int slots);
+
+// Points the palm detection and hand landmark inference nodes at the model
+// files of a variant, e.g. palm_detection_int8.tflite and
+// hand_landmark_int8.tflite for INT8. Does nothing for FULL. Throws
+// std::system_error if a model file is missing.
+void SelectHandsModel(mediapipe::CalculatorGraphConfig &config, HandsModel model);
+
+// Adds a HandGestureCalculator on the landmarks output and kHandGesturesStream
+// as a graph output.
+void AddHandGestureClassifier(mediapipe::CalculatorGraphConfig &config);
+
+// Reads the precompiled graph from the resource directory, if present.
+std::optional<mediapipe::CalculatorGraphConfig> ReadPrecompiledHandsGraphConfig();
+
+// Returns the precompiled graph and falls back to CompileHandsGraphConfig.
+mediapipe::CalculatorGraphConfig LoadHandsGraphConfig();
+
+}
+
+#endif // MEDIAPIPE_SOLUTIONS_HANDS_HANDS_GRAPH_H_
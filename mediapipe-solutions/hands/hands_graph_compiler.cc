@@ -0,0 +1,55 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Build-time tool: writes the fully expanded and validated Hands graph as a
+// binary CalculatorGraphConfig, so that Hands does not need to parse text
+// protos and expand subgraphs on every construction.
+
+#include <iostream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+
+#include "mediapipe/framework/port/file_helpers.h"
+
+#include "mediapipe-solutions/hands/hands_graph.h"
+#include "mediapipe-solutions/util/util.h"
+
+ABSL_FLAG(std::string, output_path, "", "Where to write the binary graph config.");
+
+using namespace std;
+using namespace mediapipe_solutions;
+
+int main(int argc, char **argv) {
+	absl::ParseCommandLine(argc, argv);
+
+	const auto output_path = absl::GetFlag(FLAGS_output_path);
+
+	if (output_path.empty()) {
+		cerr << "--output_path is required." << endl;
+		return EXIT_FAILURE;
+	}
+
+	string serialized;
+
+	if (!CompileHandsGraphConfig().SerializeToString(&serialized)) {
+		cerr << "Failed to serialize the hands graph." << endl;
+		return EXIT_FAILURE;
+	}
+
+	ThrowIfNotOk(mediapipe::file::SetContents(output_path, serialized));
+
+	return EXIT_SUCCESS;
+}
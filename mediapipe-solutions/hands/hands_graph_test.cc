@@ -0,0 +1,357 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/hands/hands_graph.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+// Defined by MediaPipe's default resource_util.
+ABSL_DECLARE_FLAG(std::string, resource_root_dir);
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+vector<const CalculatorGraphConfig::Node *> FindNodes(const CalculatorGraphConfig &config, const string &calculator) {
+	vector<const CalculatorGraphConfig::Node *> nodes;
+
+	for (const auto &node : config.node()) {
+		if (node.calculator() == calculator)
+			nodes.push_back(&node);
+	}
+
+	return nodes;
+}
+
+const CalculatorGraphConfig::Node &FindNode(const CalculatorGraphConfig &config, const string &calculator) {
+	const auto nodes = FindNodes(config, calculator);
+
+	if (nodes.size() != 1)
+		throw out_of_range("Expected one " + calculator + " node, found " + to_string(nodes.size()) + ".");
+
+	return *nodes.front();
+}
+
+vector<string> Inputs(const CalculatorGraphConfig::Node &node) {
+	return vector<string>(node.input_stream().begin(), node.input_stream().end());
+}
+
+bool HasInput(const CalculatorGraphConfig::Node &node, const string &stream) {
+	const auto inputs = Inputs(node);
+
+	return find(inputs.begin(), inputs.end(), stream) != inputs.end();
+}
+
+// Compares the stream name only, without tag and index.
+bool HasInputNamed(const CalculatorGraphConfig::Node &node, const string &name) {
+	for (const auto &input : node.input_stream()) {
+		if (input.substr(input.rfind(':') + 1) == name)
+			return true;
+	}
+
+	return false;
+}
+
+void ExpectValid(const CalculatorGraphConfig &config) {
+	ValidatedGraphConfig validated;
+	const auto status = validated.Initialize(config);
+
+	EXPECT_TRUE(status.ok()) << status.message();
+}
+
+TEST(HandsGraphTest, LiveConfigReplacesTheStaticNodes) {
+	const auto config = CompileHandsGraphConfig();
+
+	ExpectValid(config);
+
+	for (const auto *stream : { kMaxNumHandsStream, kMinDetectionConfidenceStream, kMinTrackingConfidenceStream }) {
+		EXPECT_NE(
+			find(config.input_stream().begin(), config.input_stream().end(), stream), config.input_stream().end()
+		) << stream;
+	}
+
+	EXPECT_TRUE(FindNodes(config, "ClipDetectionVectorSizeCalculator").empty());
+	EXPECT_TRUE(FindNodes(config, "NormalizedRectVectorHasMinSizeCalculator").empty());
+
+	// The live parameters reach the graph through input_deadline.
+	EXPECT_TRUE(HasInput(FindNode(config, "FilterDetectionsLiveCalculator"), "MIN_SCORE:min_detection_confidence__input_deadline"));
+	EXPECT_TRUE(HasInput(FindNode(config, "FilterDetectionsLiveCalculator"), "MAX_NUM:max_num_hands__input_deadline"));
+	EXPECT_TRUE(HasInput(FindNode(config, "NormalizedRectVectorHasMinSizeLiveCalculator"), "MIN_SIZE:max_num_hands__input_deadline"));
+	EXPECT_TRUE(HasInput(FindNode(config, "ClipNormalizedRectVectorSizeLiveCalculator"), "MAX_NUM:max_num_hands__input_deadline"));
+
+	const auto &thresholding = FindNode(config, "ThresholdingCalculator");
+
+	EXPECT_FALSE(thresholding.has_options());
+	EXPECT_TRUE(HasInput(thresholding, "THRESHOLD:hands_loop_min_tracking_confidence"));
+}
+
+TEST(HandsGraphTest, LiveConfigClipsHandsBeforeTheLoop) {
+	const auto config = CompileHandsGraphConfig();
+	const auto &clip = FindNode(config, "ClipNormalizedRectVectorSizeLiveCalculator");
+	const auto &begin = FindNode(config, "BeginLoopNormalizedRectCalculator");
+	const auto clipped = clip.output_stream(0).substr(clip.output_stream(0).find(':') + 1);
+
+	// BeginLoop reads the clipped rects through its deadline gate.
+	EXPECT_TRUE(HasInput(begin, "ITERABLE:" + clipped + "__hand_landmark_deadline"));
+	EXPECT_TRUE(HasInputNamed(begin, "min_tracking_confidence__input_deadline__hand_landmark_deadline"));
+}
+
+// The shape of the hand landmark loop, with a pass-through as its body.
+constexpr char kLoopGraph[] = R"pb(
+	input_stream: "rects"
+	output_stream: "loop_rects"
+	node {
+		name: "begin"
+		calculator: "BeginLoopNormalizedRectCalculator"
+		input_stream: "ITERABLE:rects"
+		output_stream: "ITEM:rect"
+		output_stream: "BATCH_END:batch_end"
+	}
+	node { name: "body" calculator: "PassThroughCalculator" input_stream: "rect" output_stream: "body_rect" }
+	node {
+		name: "end"
+		calculator: "EndLoopNormalizedRectCalculator"
+		input_stream: "ITEM:body_rect"
+		input_stream: "BATCH_END:batch_end"
+		output_stream: "ITERABLE:loop_rects"
+	}
+)pb";
+
+// Runs one frame per entry of rectCounts through config and returns the
+// x_center of every output rect by timestamp.
+map<int64_t, vector<float>> RunLoop(const CalculatorGraphConfig &config, const vector<int> &rectCounts) {
+	CalculatorGraph graph;
+	map<int64_t, vector<float>> outputs;
+
+	EXPECT_TRUE(graph.Initialize(config).ok());
+	EXPECT_TRUE(graph.ObserveOutputStream("loop_rects", [&outputs](const Packet &packet) {
+		auto &centers = outputs[packet.Timestamp().Value()];
+
+		for (const auto &rect : packet.Get<vector<NormalizedRect>>())
+			centers.push_back(rect.x_center());
+
+		return absl::OkStatus();
+	}).ok());
+	EXPECT_TRUE(graph.StartRun({}).ok());
+
+	for (size_t frame = 0; frame < rectCounts.size(); ++frame) {
+		vector<NormalizedRect> rects(rectCounts[frame]);
+
+		for (int i = 0; i < rectCounts[frame]; ++i)
+			rects[i].set_x_center(float(frame * 10 + i));
+
+		EXPECT_TRUE(graph.AddPacketToInputStream("rects", MakePacket<vector<NormalizedRect>>(move(rects)).At(Timestamp(frame))).ok());
+	}
+
+	EXPECT_TRUE(graph.CloseAllPacketSources().ok());
+	EXPECT_TRUE(graph.WaitUntilDone().ok());
+	return outputs;
+}
+
+TEST(HandsGraphTest, UnrolledLoopMatchesTheLoop) {
+	const auto looped = ParseTextProtoOrDie<CalculatorGraphConfig>(kLoopGraph);
+	// Fewer, as many and more rects than slots, and none.
+	const vector<int> rectCounts { 0, 1, 2, 3, 5 };
+	const auto expected = RunLoop(looped, rectCounts);
+
+	ASSERT_EQ(expected.at(4), (vector<float> { 40, 41, 42, 43, 44 }));
+
+	for (int slots : { 1, 2, 3 }) {
+		auto unrolled = looped;
+
+		UnrollHandLandmarkLoop(unrolled, slots);
+		ExpectValid(unrolled);
+		EXPECT_EQ(RunLoop(unrolled, rectCounts), expected) << slots << " slots";
+	}
+}
+
+TEST(HandsGraphTest, UnrollingCopiesTheLoopPerSlot) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(kLoopGraph);
+
+	UnrollHandLandmarkLoop(config, 3);
+
+	EXPECT_EQ(FindNodes(config, "BeginLoopNormalizedRectCalculator").size(), 3u);
+	EXPECT_EQ(FindNodes(config, "PassThroughCalculator").size(), 3u);
+	EXPECT_EQ(FindNodes(config, "EndLoopNormalizedRectCalculator").size(), 3u);
+
+	const auto &slicer = FindNode(config, "NormalizedRectVectorToSlotsCalculator");
+
+	EXPECT_EQ(Inputs(slicer), vector<string> { "RECTS:rects" });
+	EXPECT_EQ(
+		vector<string>(slicer.output_stream().begin(), slicer.output_stream().end()),
+		(vector<string> { "SLOT:0:rects__slot0", "SLOT:1:rects__slot1", "SLOT:2:rects__slot2" })
+	);
+	EXPECT_EQ(
+		Inputs(FindNode(config, "ConcatenateNormalizedRectSlotsCalculator")),
+		(vector<string> { "SLOT:0:loop_rects__slot0", "SLOT:1:loop_rects__slot1", "SLOT:2:loop_rects__slot2" })
+	);
+}
+
+TEST(HandsGraphTest, UnrolledHandsGraphValidates) {
+	for (int slots : { 1, 4 }) {
+		auto config = CompileHandsGraphConfig();
+
+		UnrollHandLandmarkLoop(config, slots);
+		ExpectValid(config);
+		EXPECT_EQ(FindNodes(config, "BeginLoopNormalizedRectCalculator").size(), size_t(slots)) << slots << " slots";
+		EXPECT_EQ(FindNodes(config, "NormalizedRectVectorToSlotsCalculator").size(), slots > 1 ? 1u : 0u);
+	}
+}
+
+// Inference nodes for the two hand models and an unrelated one.
+constexpr char kInferenceGraph[] = R"pb(
+	input_stream: "image_tensors"
+	node {
+		calculator: "InferenceCalculator"
+		input_stream: "TENSORS:image_tensors"
+		output_stream: "TENSORS:palm_tensors"
+		options {
+			[mediapipe.InferenceCalculatorOptions.ext] { model_path: "mediapipe/modules/palm_detection/palm_detection.tflite" }
+		}
+	}
+	node {
+		calculator: "InferenceCalculatorCpu"
+		input_stream: "TENSORS:image_tensors"
+		output_stream: "TENSORS:landmark_tensors"
+		options {
+			[mediapipe.InferenceCalculatorOptions.ext] { model_path: "mediapipe/modules/hand_landmark/hand_landmark.tflite" }
+		}
+	}
+	node {
+		calculator: "InferenceCalculator"
+		input_stream: "TENSORS:image_tensors"
+		output_stream: "TENSORS:face_tensors"
+		options {
+			[mediapipe.InferenceCalculatorOptions.ext] { model_path: "mediapipe/modules/face_landmark/face_landmark.tflite" }
+		}
+	}
+)pb";
+
+vector<string> ModelPaths(const CalculatorGraphConfig &config) {
+	vector<string> paths;
+
+	for (const auto &node : config.node()) {
+		if (node.options().HasExtension(InferenceCalculatorOptions::ext))
+			paths.push_back(node.options().GetExtension(InferenceCalculatorOptions::ext).model_path());
+	}
+
+	return paths;
+}
+
+// Points resource_root_dir at an empty directory for the variant files.
+class SelectHandsModelTest : public testing::Test {
+	protected:
+		filesystem::path root_;
+		string previousRoot_;
+
+		void SetUp() override {
+			root_ = filesystem::path(testing::TempDir())
+				/ testing::UnitTest::GetInstance()->current_test_info()->name();
+			filesystem::remove_all(root_);
+			filesystem::create_directories(root_ / kHandsModelDirectory);
+			previousRoot_ = absl::GetFlag(FLAGS_resource_root_dir);
+			absl::SetFlag(&FLAGS_resource_root_dir, root_.string());
+		}
+
+		void TearDown() override {
+			absl::SetFlag(&FLAGS_resource_root_dir, previousRoot_);
+			filesystem::remove_all(root_);
+		}
+
+		void Install(const string &name) {
+			ofstream(root_ / kHandsModelDirectory / name).put('\0');
+		}
+};
+
+TEST_F(SelectHandsModelTest, FullKeepsTheGraph) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(kInferenceGraph);
+	const auto before = config.SerializeAsString();
+
+	SelectHandsModel(config, HandsModel::FULL);
+	EXPECT_EQ(config.SerializeAsString(), before);
+}
+
+TEST_F(SelectHandsModelTest, SelectsTheVariantOfBothHandModels) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(kInferenceGraph);
+
+	Install("palm_detection_int8.tflite");
+	Install("hand_landmark_int8.tflite");
+	SelectHandsModel(config, HandsModel::INT8);
+
+	EXPECT_EQ(ModelPaths(config), (vector<string> {
+		string(kHandsModelDirectory) + "/palm_detection_int8.tflite",
+		string(kHandsModelDirectory) + "/hand_landmark_int8.tflite",
+		"mediapipe/modules/face_landmark/face_landmark.tflite"
+	}));
+}
+
+TEST_F(SelectHandsModelTest, SelectsTheVariantInTheHandsGraph) {
+	auto config = CompileHandsGraphConfig();
+
+	Install("palm_detection_lite.tflite");
+	Install("hand_landmark_lite.tflite");
+	SelectHandsModel(config, HandsModel::LITE);
+
+	const auto paths = ModelPaths(config);
+
+	EXPECT_EQ(count(paths.begin(), paths.end(), string(kHandsModelDirectory) + "/palm_detection_lite.tflite"), 1);
+	EXPECT_EQ(count(paths.begin(), paths.end(), string(kHandsModelDirectory) + "/hand_landmark_lite.tflite"), 1);
+}
+
+TEST_F(SelectHandsModelTest, ThrowsWithoutAnInferenceNode) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+		input_stream: "in"
+		node { calculator: "PassThroughCalculator" input_stream: "in" output_stream: "out" }
+	)pb");
+
+	Install("palm_detection_lite.tflite");
+	Install("hand_landmark_lite.tflite");
+	EXPECT_THROW(SelectHandsModel(config, HandsModel::LITE), out_of_range);
+}
+
+TEST_F(SelectHandsModelTest, ThrowsForAMissingVariant) {
+	auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(kInferenceGraph);
+
+	// Only one of the two files is installed.
+	Install("palm_detection_int8.tflite");
+
+	try {
+		SelectHandsModel(config, HandsModel::INT8);
+		FAIL() << "Expected std::system_error.";
+	} catch (const system_error &error) {
+		EXPECT_EQ(error.code(), make_error_code(errc::no_such_file_or_directory));
+		EXPECT_NE(string(error.what()).find("hand_landmark_int8.tflite"), string::npos) << error.what();
+	}
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
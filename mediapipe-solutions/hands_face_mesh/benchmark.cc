@@ -0,0 +1,138 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares HandsFaceMesh with a Hands graph and a separate face mesh graph fed
+// with their own copy of every frame. The frame copies are part of the timing,
+// as they are part of what the combined graph saves.
+
+#include <future>
+#include <memory>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "benchmark/benchmark.h"
+
+#include "opencv2/imgcodecs/imgcodecs.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+
+#include "../hands/hands.h"
+#include "../hands_face_mesh/hands_face_mesh.h"
+#include "../hands_face_mesh/hands_face_mesh_graph.h"
+
+ABSL_FLAG(std::string, image_path, "",
+	"Image fed to the benchmarks. A blank 1280x720 frame is used if empty.");
+
+using namespace std;
+using namespace mediapipe;
+using namespace mediapipe_solutions;
+
+namespace {
+	// The face mesh half of HandsFaceMesh as a graph of its own.
+	class FaceMesh : public SolutionBase {
+		public:
+			FaceMesh() : SolutionBase(CompileFaceMeshGraphConfig(), CreateSideInputs(), { string(kMultiFaceLandmarksStream) }) {
+			}
+
+			unordered_map<string, Any> Process(unique_ptr<ImageFrame> image) {
+				return SolutionBase::Process("input_video", Any::Adopt(move(image)));
+			}
+		private:
+			static unordered_map<string, Any> CreateSideInputs() {
+				unordered_map<string, Any> side_inputs;
+
+				side_inputs.emplace(kNumFacesSidePacket, 1);
+				return side_inputs;
+			}
+	};
+
+	const ImageFrame &BenchmarkFrame() {
+		static const auto frame = []() {
+			const auto image_path = absl::GetFlag(FLAGS_image_path);
+			cv::Mat image;
+
+			if (!image_path.empty()) {
+				cv::cvtColor(cv::imread(image_path), image, cv::COLOR_BGR2RGB);
+			}
+			else {
+				image = cv::Mat::zeros(720, 1280, CV_8UC3);
+			}
+
+			auto result = make_unique<ImageFrame>(
+				ImageFormat::SRGB, image.cols, image.rows, ImageFrame::kDefaultAlignmentBoundary);
+			image.copyTo(formats::MatView(result.get()));
+			return result;
+		}();
+
+		return *frame;
+	}
+
+	unique_ptr<ImageFrame> CopyFrame(const ImageFrame &frame) {
+		auto copy = make_unique<ImageFrame>();
+
+		copy->CopyFrom(frame, ImageFrame::kDefaultAlignmentBoundary);
+		return copy;
+	}
+
+	void SetFrameCounters(benchmark::State &state, int copies) {
+		const auto &frame = BenchmarkFrame();
+
+		state.counters["frame_copies"] = copies;
+		state.SetBytesProcessed(int64_t(state.iterations()) * copies * frame.WidthStep() * frame.Height());
+	}
+
+	void BM_OneGraph(benchmark::State &state) {
+		HandsFaceMesh handsFaceMesh;
+
+		handsFaceMesh.Process(CopyFrame(BenchmarkFrame()));
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(handsFaceMesh.Process(CopyFrame(BenchmarkFrame())));
+
+		SetFrameCounters(state, 1);
+		handsFaceMesh.Close();
+	}
+	BENCHMARK(BM_OneGraph)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+	// Both graphs run concurrently, as they would in an application.
+	void BM_TwoGraphs(benchmark::State &state) {
+		Hands hands;
+		FaceMesh faceMesh;
+
+		hands.WarmUp(CopyFrame(BenchmarkFrame()));
+		faceMesh.Process(CopyFrame(BenchmarkFrame()));
+
+		for (auto _ : state) {
+			auto faces = async(launch::async, [&faceMesh]() { return faceMesh.Process(CopyFrame(BenchmarkFrame())); });
+
+			benchmark::DoNotOptimize(hands.Process(CopyFrame(BenchmarkFrame())));
+			benchmark::DoNotOptimize(faces.get());
+		}
+
+		SetFrameCounters(state, 2);
+		hands.Close();
+		faceMesh.Close();
+	}
+	BENCHMARK(BM_TwoGraphs)->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+int main(int argc, char **argv) {
+	benchmark::Initialize(&argc, argv);
+	absl::ParseCommandLine(argc, argv);
+	benchmark::RunSpecifiedBenchmarks();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hands_face_mesh.h"
+#include "hands_face_mesh_graph.h"
+
+#include <algorithm>
+
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+
+#include "mediapipe-solutions/hands/hands_graph.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	unordered_map<string, Any> CreateSideInputs(int max_num_hands, int max_num_faces) {
+		unordered_map<string, Any> side_inputs;
+
+		side_inputs.emplace("num_hands", max_num_hands);
+		side_inputs.emplace(kNumFacesSidePacket, max_num_faces);
+		return side_inputs;
+	}
+}
+
+HandsFaceMesh::HandsFaceMesh(
+		int max_num_hands,
+		float min_detection_confidence, double min_tracking_confidence,
+		int max_num_faces,
+		ExecutionOptions execution
+	)
+	: SolutionBase(
+		CompileHandsFaceMeshGraphConfig(),
+		CreateSideInputs(max_num_hands, max_num_faces),
+		{ { string("landmarks"), string("handedness"), string(kMultiFaceLandmarksStream) } },
+		{
+			CalculatorOption::Set(
+				"handlandmarktrackingcpu__palmdetectioncpu__TensorsToDetectionsCalculator",
+				&TensorsToDetectionsCalculatorOptions::set_min_score_thresh,
+				min(min_detection_confidence, kMinDetectionConfidenceFloor)
+			)
+		},
+		move(execution)
+	),
+	max_num_hands_(max_num_hands),
+	min_detection_confidence_(min_detection_confidence),
+	min_tracking_confidence_(min_tracking_confidence) {
+}
+
+HandsFaceMeshResult HandsFaceMesh::Process(unique_ptr<ImageFrame> image, Deadline deadline) {
+	auto output = SolutionBase::Process(CreateInputs(move(image)), deadline);
+	HandsFaceMeshResult result;
+
+	if (output.count(kMultiFaceLandmarksStream)) {
+		result.faces = move(output.at(kMultiFaceLandmarksStream)).Get<vector<NormalizedLandmarkList>>();
+		output.erase(kMultiFaceLandmarksStream);
+	}
+
+	result.hands = Hands::ToHands(move(output));
+	return result;
+}
+
+void HandsFaceMesh::SetMaxNumHands(int max_num_hands) {
+	max_num_hands_ = max_num_hands;
+}
+
+void HandsFaceMesh::SetMinDetectionConfidence(float min_detection_confidence) {
+	min_detection_confidence_ = min_detection_confidence;
+}
+
+void HandsFaceMesh::SetMinTrackingConfidence(double min_tracking_confidence) {
+	min_tracking_confidence_ = min_tracking_confidence;
+}
+
+unordered_map<string_view, Any> HandsFaceMesh::CreateInputs(unique_ptr<ImageFrame> image) const {
+	unordered_map<string_view, Any> inputs;
+
+	inputs.emplace("input_video", Any::Adopt(move(image)));
+	inputs.emplace(kMaxNumHandsStream, max_num_hands_.load());
+	inputs.emplace(kMinDetectionConfidenceStream, min_detection_confidence_.load());
+	inputs.emplace(kMinTrackingConfidenceStream, min_tracking_confidence_.load());
+	return inputs;
+}
+
+}
@@ -0,0 +1,67 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_HANDS_FACE_MESH_HANDS_FACE_MESH_H_
+#define MEDIAPIPE_SOLUTIONS_HANDS_FACE_MESH_HANDS_FACE_MESH_H_
+
+#include <atomic>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../solution_base.h"
+#include "../hands/hands.h"
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe_solutions {
+
+struct HandsFaceMeshResult {
+	std::unordered_map<Handedness, HandNormalizedLandmarkList> hands;
+	std::vector<mediapipe::NormalizedLandmarkList> faces;
+};
+
+// Hand tracking and face mesh in one graph. Every frame is submitted once and
+// both subgraphs read the same image packet; the results of both come back
+// together for that frame.
+class HandsFaceMesh : public SolutionBase {
+	public:
+		HandsFaceMesh(
+			int max_num_hands = 2,
+			float min_detection_confidence = 0.5, double min_tracking_confidence = 0.5,
+			int max_num_faces = 1,
+			ExecutionOptions execution = {}
+		);
+
+		// Throws std::system_error with std::errc::timed_out if the result is
+		// not ready by deadline.
+		HandsFaceMeshResult Process(std::unique_ptr<mediapipe::ImageFrame> image, Deadline deadline = std::nullopt);
+
+		// As on Hands: take effect with the next frame without restarting the
+		// graph, and may be called from any thread. max_num_faces is fixed.
+		void SetMaxNumHands(int max_num_hands);
+		void SetMinDetectionConfidence(float min_detection_confidence);
+		void SetMinTrackingConfidence(double min_tracking_confidence);
+	private:
+		std::atomic<int> max_num_hands_;
+		std::atomic<float> min_detection_confidence_;
+		std::atomic<double> min_tracking_confidence_;
+
+		std::unordered_map<std::string_view, Any> CreateInputs(std::unique_ptr<mediapipe::ImageFrame> image) const;
+};
+
+}
+
+#endif // MEDIAPIPE_SOLUTIONS_HANDS_FACE_MESH_HANDS_FACE_MESH_H_
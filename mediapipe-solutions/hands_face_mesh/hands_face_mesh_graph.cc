@@ -0,0 +1,85 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hands_face_mesh_graph.h"
+
+#include <algorithm>
+#include <string>
+
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+#include "mediapipe-solutions/deadline.h"
+#include "mediapipe-solutions/hands/hands_graph.h"
+#include "mediapipe-solutions/util/util.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	constexpr char kFaceMeshGraph[] =
+		"input_stream: \"input_video\""
+		"output_stream: \"multi_face_landmarks\""
+		"node {"
+		"calculator: \"FaceLandmarkFrontCpu\""
+		"input_stream: \"IMAGE:input_video\""
+		"input_side_packet: \"NUM_FACES:num_faces\""
+		"output_stream: \"LANDMARKS:multi_face_landmarks\""
+		"output_stream: \"DETECTIONS:face_detections\""
+		"output_stream: \"ROIS_FROM_LANDMARKS:face_rects_from_landmarks\""
+		"output_stream: \"ROIS_FROM_DETECTIONS:face_rects_from_detections\""
+		"}";
+
+	template <typename Field>
+	void AddMissing(Field &target, const Field &source) {
+		for (const auto &item : source) {
+			if (find(target.begin(), target.end(), item) == target.end())
+				*target.Add() = item;
+		}
+	}
+}
+
+CalculatorGraphConfig CompileFaceMeshGraphConfig() {
+	return ExpandGraphConfig(ParseTextProtoOrDie<CalculatorGraphConfig>(string(kFaceMeshGraph)));
+}
+
+CalculatorGraphConfig CompileHandsFaceMeshGraphConfig() {
+	auto config = LoadHandsGraphConfig();
+	auto faceMesh = CompileFaceMeshGraphConfig();
+
+	// The face nodes get their own gates before they join the hands graph,
+	// whose gates already cover the hand nodes only.
+	AddDeadlineGate(faceMesh, "input_video", "face_input_deadline");
+
+	for (auto &node : *faceMesh.mutable_node()) {
+		if (node.calculator() == "BeginLoopNormalizedRectCalculator") {
+			AddDeadlineGate(faceMesh, node, "face_landmark_deadline");
+			break;
+		}
+	}
+
+	// Expanded node names carry their subgraph prefix, and the two graphs
+	// share no streams other than input_video.
+	AddMissing(*config.mutable_input_stream(), faceMesh.input_stream());
+	AddMissing(*config.mutable_output_stream(), faceMesh.output_stream());
+	AddMissing(*config.mutable_input_side_packet(), faceMesh.input_side_packet());
+
+	for (const auto &node : faceMesh.node())
+		*config.add_node() = node;
+
+	return ExpandGraphConfig(config);
+}
+
+}
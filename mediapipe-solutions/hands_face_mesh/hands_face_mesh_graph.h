@@ -0,0 +1,37 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_HANDS_FACE_MESH_HANDS_FACE_MESH_GRAPH_H_
+#define MEDIAPIPE_SOLUTIONS_HANDS_FACE_MESH_HANDS_FACE_MESH_GRAPH_H_
+
+#include "mediapipe/framework/calculator.pb.h"
+
+namespace mediapipe_solutions {
+
+// Output stream of the face landmarks, a vector of NormalizedLandmarkList.
+constexpr char kMultiFaceLandmarksStream[] = "multi_face_landmarks";
+
+// Side packet with the maximum number of faces, an int.
+constexpr char kNumFacesSidePacket[] = "num_faces";
+
+// Face mesh alone on input_video, expanded.
+mediapipe::CalculatorGraphConfig CompileFaceMeshGraphConfig();
+
+// The hands graph of LoadHandsGraphConfig and the face mesh graph merged into
+// one graph. Both read the same input_video packet.
+mediapipe::CalculatorGraphConfig CompileHandsFaceMeshGraphConfig();
+
+}
+
+#endif // MEDIAPIPE_SOLUTIONS_HANDS_FACE_MESH_HANDS_FACE_MESH_GRAPH_H_
@@ -0,0 +1,88 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/hands_face_mesh/hands_face_mesh_graph.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+vector<const CalculatorGraphConfig::Node *> FindNamedNodes(const CalculatorGraphConfig &config, const string &name) {
+	vector<const CalculatorGraphConfig::Node *> nodes;
+
+	for (const auto &node : config.node()) {
+		if (node.name() == name)
+			nodes.push_back(&node);
+	}
+
+	return nodes;
+}
+
+// Compares the stream name only, without tag and index.
+bool ReadsStream(const CalculatorGraphConfig::Node &node, const string &name) {
+	for (const auto &input : node.input_stream()) {
+		if (input.substr(input.rfind(':') + 1) == name)
+			return true;
+	}
+
+	return false;
+}
+
+TEST(HandsFaceMeshGraphTest, MergedGraphValidates) {
+	ValidatedGraphConfig validated;
+	const auto status = validated.Initialize(CompileHandsFaceMeshGraphConfig());
+
+	EXPECT_TRUE(status.ok()) << status.message();
+}
+
+TEST(HandsFaceMeshGraphTest, KeepsTheFaceAndHandGatesApart) {
+	const auto config = CompileHandsFaceMeshGraphConfig();
+	set<string> outputs;
+
+	for (const string gate : { "input_deadline", "hand_landmark_deadline", "face_input_deadline", "face_landmark_deadline" }) {
+		const auto nodes = FindNamedNodes(config, gate);
+
+		ASSERT_EQ(nodes.size(), 1u) << gate;
+		EXPECT_EQ(nodes.front()->calculator(), "DeadlineGateCalculator") << gate;
+
+		for (const auto &output : nodes.front()->output_stream())
+			EXPECT_TRUE(outputs.insert(output).second) << output << " is written by two gates.";
+	}
+
+	// Each side reads the frame through its own gate only.
+	for (const auto &node : config.node()) {
+		if (node.name() == "input_deadline" or node.name() == "face_input_deadline")
+			EXPECT_TRUE(ReadsStream(node, "input_video")) << node.name();
+		else
+			EXPECT_FALSE(ReadsStream(node, "input_video")) << node.name();
+
+		EXPECT_FALSE(
+			ReadsStream(node, "input_video__input_deadline") and
+			ReadsStream(node, "input_video__face_input_deadline")
+		) << node.name();
+	}
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
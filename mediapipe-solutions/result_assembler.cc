@@ -0,0 +1,102 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/result_assembler.h"
+
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+
+namespace {
+	// Runs before the slots are allocated, which a negative capacity must not
+	// reach.
+	int CheckCapacity(int capacity) {
+		if (capacity <= 0 or (capacity & (capacity - 1)) != 0)
+			throw invalid_argument("The result capacity must be a power of two.");
+
+		return capacity;
+	}
+}
+
+ResultAssembler::ResultAssembler(int outputs, int capacity) :
+	outputs_(outputs),
+	mask_(uint64_t(CheckCapacity(capacity)) - 1),
+	slots_(new Slot[capacity]),
+	cursors_(outputs, 0) {
+}
+
+void ResultAssembler::Begin(Timestamp timestamp, Callback callback) {
+	const auto sequence = begun_.load(memory_order_relaxed);
+	auto &slot = slots_[sequence & mask_];
+
+	// Only happens with more than capacity results in flight.
+	while (slot.pending.load(memory_order_acquire))
+		this_thread::yield();
+
+	slot.timestamp = timestamp;
+	slot.callback = move(callback);
+	slot.packets.assign(outputs_, Packet());
+	slot.remaining.store(outputs_, memory_order_relaxed);
+	slot.pending.store(true, memory_order_relaxed);
+
+	// Publishes the slot to the observers.
+	begun_.store(sequence + 1, memory_order_release);
+
+	if (outputs_ == 0)
+		Settle(slot, -1, nullptr);
+}
+
+void ResultAssembler::Add(int output, const Packet &packet) {
+	auto &cursor = cursors_.at(output);
+	const auto begun = begun_.load(memory_order_acquire);
+
+	for (; cursor < begun; ++cursor) {
+		auto &slot = slots_[cursor & mask_];
+
+		if (slot.timestamp > packet.Timestamp())
+			break;
+
+		Settle(slot, output, slot.timestamp == packet.Timestamp() ? &packet : nullptr);
+	}
+}
+
+void ResultAssembler::Flush() {
+	for (int output = 0; output < outputs_; ++output)
+		Add(output, Packet().At(Timestamp::Max()));
+}
+
+void ResultAssembler::Settle(Slot &slot, int output, const Packet *packet) {
+	if (packet and !packet->IsEmpty())
+		slot.packets[output] = *packet;
+
+	if (output >= 0 and slot.remaining.fetch_sub(1, memory_order_acq_rel) != 1)
+		return;
+
+	// This thread settled the last output and owns the slot until it is
+	// released for the next Begin.
+	auto callback = move(slot.callback);
+	auto packets = move(slot.packets);
+	const auto timestamp = slot.timestamp;
+
+	slot.callback = nullptr;
+	slot.pending.store(false, memory_order_release);
+
+	callback(timestamp, move(packets));
+}
+
+}	// namespace mediapipe_solutions
@@ -0,0 +1,84 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_RESULT_ASSEMBLER_H_
+#define MEDIAPIPE_SOLUTIONS_RESULT_ASSEMBLER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe_solutions {
+
+// Joins the packets of several graph output streams into one result per
+// input timestamp, without locks.
+//
+// A single submitting thread calls Begin for every timestamp, in increasing
+// order, before sending the inputs. Each output stream reports its packets and
+// timestamp bounds through Add from its observer callback. An output is
+// settled for a timestamp when it delivers a packet there or its bound moves
+// past it. The thread that settles the last output of a timestamp runs that
+// timestamp's callback, with one packet per output, empty where the output
+// produced nothing.
+//
+// Pending timestamps live in a ring of capacity slots. Begin waits while the
+// slot it needs is still pending.
+class ResultAssembler {
+	public:
+		using Callback = std::function<void(mediapipe::Timestamp, std::vector<mediapipe::Packet> &&)>;
+
+		ResultAssembler(int outputs, int capacity);
+
+		ResultAssembler(const ResultAssembler &) = delete;
+		ResultAssembler &operator=(const ResultAssembler &) = delete;
+
+		void Begin(mediapipe::Timestamp timestamp, Callback callback);
+
+		// packet may be empty, in which case only its timestamp counts as a
+		// bound. Calls for one output must not overlap.
+		void Add(int output, const mediapipe::Packet &packet);
+
+		// Settles every pending timestamp with what has arrived so far. Only
+		// valid once no more Add calls can happen, e.g. after the graph is done.
+		void Flush();
+	private:
+		struct Slot {
+			std::atomic<bool> pending { false };
+			std::atomic<int> remaining { 0 };
+			mediapipe::Timestamp timestamp;
+			Callback callback;
+			std::vector<mediapipe::Packet> packets;
+		};
+
+		const int outputs_;
+		const uint64_t mask_;
+		std::unique_ptr<Slot[]> slots_;
+
+		// Number of timestamps begun; written by the submitting thread only.
+		std::atomic<uint64_t> begun_ { 0 };
+		// Per output, the first timestamp it has not settled yet. Each entry is
+		// only touched by the observer of that output.
+		std::vector<uint64_t> cursors_;
+
+		void Settle(Slot &slot, int output, const mediapipe::Packet *packet);
+};
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_RESULT_ASSEMBLER_H_
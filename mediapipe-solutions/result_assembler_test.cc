@@ -0,0 +1,173 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/result_assembler.h"
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+// Records every settled timestamp with its packets.
+struct Results {
+	map<int64_t, vector<Packet>> settled;
+
+	ResultAssembler::Callback Collect() {
+		return [this](Timestamp timestamp, vector<Packet> &&packets) {
+			EXPECT_EQ(settled.count(timestamp.Value()), 0u) << "Settled twice: " << timestamp.Value();
+			settled[timestamp.Value()] = move(packets);
+		};
+	}
+};
+
+TEST(ResultAssemblerTest, CompletesOnceEveryOutputDelivered) {
+	ResultAssembler assembler(2, 4);
+	Results results;
+
+	assembler.Begin(Timestamp(10), results.Collect());
+	assembler.Add(0, MakePacket<int>(1).At(Timestamp(10)));
+	EXPECT_TRUE(results.settled.empty());
+
+	assembler.Add(1, MakePacket<int>(2).At(Timestamp(10)));
+
+	ASSERT_EQ(results.settled.count(10), 1u);
+	EXPECT_EQ(results.settled[10][0].Get<int>(), 1);
+	EXPECT_EQ(results.settled[10][1].Get<int>(), 2);
+}
+
+TEST(ResultAssemblerTest, TimestampBoundsSettleOutputsAsEmpty) {
+	ResultAssembler assembler(2, 4);
+	Results results;
+
+	assembler.Begin(Timestamp(10), results.Collect());
+	assembler.Add(0, MakePacket<int>(1).At(Timestamp(10)));
+	// Output 1 produced nothing at 10; its bound moved past it.
+	assembler.Add(1, Packet().At(Timestamp(10)));
+
+	ASSERT_EQ(results.settled.count(10), 1u);
+	EXPECT_FALSE(results.settled[10][0].IsEmpty());
+	EXPECT_TRUE(results.settled[10][1].IsEmpty());
+}
+
+TEST(ResultAssemblerTest, LaterPacketsSettleEarlierTimestamps) {
+	ResultAssembler assembler(1, 4);
+	Results results;
+
+	assembler.Begin(Timestamp(10), results.Collect());
+	assembler.Begin(Timestamp(20), results.Collect());
+	assembler.Begin(Timestamp(30), results.Collect());
+	assembler.Add(0, MakePacket<int>(3).At(Timestamp(20)));
+
+	ASSERT_EQ(results.settled.size(), 2u);
+	EXPECT_TRUE(results.settled[10][0].IsEmpty());
+	EXPECT_EQ(results.settled[20][0].Get<int>(), 3);
+	EXPECT_EQ(results.settled.count(30), 0u);
+}
+
+TEST(ResultAssemblerTest, FlushSettlesWhatHasArrived) {
+	ResultAssembler assembler(2, 4);
+	Results results;
+
+	assembler.Begin(Timestamp(10), results.Collect());
+	assembler.Begin(Timestamp(20), results.Collect());
+	assembler.Add(0, MakePacket<int>(1).At(Timestamp(10)));
+	assembler.Flush();
+
+	ASSERT_EQ(results.settled.size(), 2u);
+	EXPECT_EQ(results.settled[10][0].Get<int>(), 1);
+	EXPECT_TRUE(results.settled[10][1].IsEmpty());
+	EXPECT_TRUE(results.settled[20][0].IsEmpty());
+	EXPECT_TRUE(results.settled[20][1].IsEmpty());
+
+	// Nothing is left to settle.
+	assembler.Flush();
+	EXPECT_EQ(results.settled.size(), 2u);
+}
+
+TEST(ResultAssemblerTest, WithoutOutputsCompletesInBegin) {
+	ResultAssembler assembler(0, 4);
+	Results results;
+
+	assembler.Begin(Timestamp(10), results.Collect());
+
+	ASSERT_EQ(results.settled.count(10), 1u);
+	EXPECT_TRUE(results.settled[10].empty());
+}
+
+TEST(ResultAssemblerTest, RequiresPowerOfTwoCapacity) {
+	EXPECT_THROW(ResultAssembler(1, 0), invalid_argument);
+	EXPECT_THROW(ResultAssembler(1, -4), invalid_argument);
+	EXPECT_THROW(ResultAssembler(1, numeric_limits<int>::min()), invalid_argument);
+	EXPECT_THROW(ResultAssembler(1, 6), invalid_argument);
+}
+
+TEST(ResultAssemblerTest, ReusesSlotsWithConcurrentObservers) {
+	constexpr int kOutputs = 3;
+	constexpr int kTimestamps = 10000;
+	// Far fewer slots than timestamps, so Begin has to wait for settling.
+	ResultAssembler assembler(kOutputs, 8);
+	atomic<int> begun { 0 };
+	atomic<int> completed { 0 };
+	atomic<int> wrong { 0 };
+	vector<thread> observers;
+
+	for (int output = 0; output < kOutputs; ++output) {
+		observers.emplace_back([&, output]() {
+			for (int i = 0; i < kTimestamps; ++i) {
+				while (begun.load() <= i)
+					this_thread::yield();
+
+				// Every other output skips odd timestamps. Observers report
+				// the skip as an empty packet at the settled timestamp.
+				if (output % 2 == 1 and i % 2 == 1)
+					assembler.Add(output, Packet().At(Timestamp(i)));
+				else
+					assembler.Add(output, MakePacket<int>(i).At(Timestamp(i)));
+			}
+		});
+	}
+
+	for (int i = 0; i < kTimestamps; ++i) {
+		assembler.Begin(Timestamp(i), [&](Timestamp timestamp, vector<Packet> &&packets) {
+			for (int output = 0; output < kOutputs; ++output) {
+				const bool skipped = output % 2 == 1 and timestamp.Value() % 2 == 1;
+
+				if (skipped ? !packets[output].IsEmpty() : packets[output].Get<int>() != timestamp.Value())
+					++wrong;
+			}
+
+			++completed;
+		});
+		begun.store(i + 1);
+	}
+
+	for (auto &observer : observers)
+		observer.join();
+
+	EXPECT_EQ(completed.load(), kTimestamps);
+	EXPECT_EQ(wrong.load(), 0);
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
@@ -0,0 +1,212 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/server/frame_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+using namespace std;
+
+namespace {
+	constexpr uint32_t kMagic = 0x4d505346;	// "MPSF"
+	constexpr size_t kSlotAlignment = 64;
+	constexpr size_t kHeaderSize = 4096;
+
+	inline size_t AlignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	[[noreturn]] void ThrowErrno(const string &what) {
+		throw system_error(errno, generic_category(), what);
+	}
+}
+
+namespace mediapipe_solutions {
+namespace server {
+
+FrameRing FrameRing::Create(string name, uint32_t slot_count, size_t slot_size) {
+	if (slot_count == 0 or slot_size == 0)
+		throw invalid_argument("Frame ring must have at least one non-empty slot.");
+
+	slot_size = AlignUp(slot_size, kSlotAlignment);
+
+	const size_t mapping_size = kHeaderSize + size_t(slot_count) * slot_size;
+	const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+	if (fd < 0)
+		ThrowErrno("shm_open(" + name + ")");
+
+	if (ftruncate(fd, off_t(mapping_size)) != 0) {
+		const int error = errno;
+		close(fd);
+		shm_unlink(name.c_str());
+		errno = error;
+		ThrowErrno("ftruncate(" + name + ")");
+	}
+
+	void *mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		ThrowErrno("mmap(" + name + ")");
+	}
+
+	auto &header = *static_cast<Header *>(mapping);
+	header.magic = kMagic;
+	header.slot_count = slot_count;
+	header.slot_size = slot_size;
+	header.slots_offset = kHeaderSize;
+
+	return FrameRing(move(name), true, mapping, mapping_size, slot_count, slot_size, kHeaderSize);
+}
+
+FrameRing FrameRing::Open(string name) {
+	const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+
+	if (fd < 0)
+		ThrowErrno("shm_open(" + name + ")");
+
+	struct stat status;
+
+	if (fstat(fd, &status) != 0) {
+		const int error = errno;
+		close(fd);
+		errno = error;
+		ThrowErrno("fstat(" + name + ")");
+	}
+
+	const size_t mapping_size = size_t(status.st_size);
+
+	if (mapping_size < kHeaderSize) {
+		close(fd);
+		throw runtime_error("Frame ring " + name + " is truncated.");
+	}
+
+	void *mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		ThrowErrno("mmap(" + name + ")");
+
+	// A private copy, so the fields checked are the fields used.
+	Header header;
+
+	memcpy(&header, mapping, sizeof(header));
+
+	// Ordered so that no step can overflow.
+	const bool valid = header.magic == kMagic
+		and header.slot_count > 0 and header.slot_size > 0
+		and header.slots_offset >= sizeof(Header) and header.slots_offset <= mapping_size
+		and header.slot_size <= mapping_size - header.slots_offset
+		and header.slot_count <= (mapping_size - header.slots_offset) / header.slot_size;
+
+	if (!valid) {
+		munmap(mapping, mapping_size);
+		throw runtime_error("Frame ring " + name + " has an invalid header.");
+	}
+
+	return FrameRing(
+		move(name), false, mapping, mapping_size,
+		header.slot_count, size_t(header.slot_size), size_t(header.slots_offset)
+	);
+}
+
+FrameRing::FrameRing(
+	string name, bool owner, void *mapping, size_t mapping_size,
+	uint32_t slot_count, size_t slot_size, size_t slots_offset
+) :
+	name_(move(name)),
+	owner_(owner),
+	mapping_(mapping),
+	mapping_size_(mapping_size),
+	slot_count_(slot_count),
+	slot_size_(slot_size),
+	slots_offset_(slots_offset) {
+}
+
+FrameRing::FrameRing(FrameRing &&other) :
+	name_(move(other.name_)),
+	owner_(exchange(other.owner_, false)),
+	mapping_(exchange(other.mapping_, nullptr)),
+	mapping_size_(exchange(other.mapping_size_, 0)),
+	slot_count_(exchange(other.slot_count_, 0)),
+	slot_size_(exchange(other.slot_size_, 0)),
+	slots_offset_(exchange(other.slots_offset_, 0)) {
+}
+
+FrameRing::~FrameRing() {
+	Release();
+}
+
+FrameRing &FrameRing::operator=(FrameRing &&other) {
+	if (this != &other) {
+		Release();
+		name_ = move(other.name_);
+		owner_ = exchange(other.owner_, false);
+		mapping_ = exchange(other.mapping_, nullptr);
+		mapping_size_ = exchange(other.mapping_size_, 0);
+		slot_count_ = exchange(other.slot_count_, 0);
+		slot_size_ = exchange(other.slot_size_, 0);
+		slots_offset_ = exchange(other.slots_offset_, 0);
+	}
+
+	return *this;
+}
+
+void FrameRing::Release() {
+	if (mapping_)
+		munmap(mapping_, mapping_size_);
+
+	if (owner_)
+		shm_unlink(name_.c_str());
+
+	mapping_ = nullptr;
+	owner_ = false;
+}
+
+const string &FrameRing::name() const {
+	return name_;
+}
+
+uint32_t FrameRing::slot_count() const {
+	return slot_count_;
+}
+
+size_t FrameRing::slot_size() const {
+	return slot_size_;
+}
+
+uint8_t *FrameRing::slot(uint32_t index) {
+	return const_cast<uint8_t *>(as_const(*this).slot(index));
+}
+
+const uint8_t *FrameRing::slot(uint32_t index) const {
+	if (index >= slot_count_)
+		throw out_of_range("Frame ring slot out of range.");
+
+	return static_cast<const uint8_t *>(mapping_) + slots_offset_ + index * slot_size_;
+}
+
+}	// namespace server
+}	// namespace mediapipe_solutions
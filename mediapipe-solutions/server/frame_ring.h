@@ -0,0 +1,77 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_SERVER_FRAME_RING_H_
+#define MEDIAPIPE_SOLUTIONS_SERVER_FRAME_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mediapipe_solutions {
+namespace server {
+
+// A fixed number of equally sized pixel buffers in a POSIX shared memory
+// object. The client creates the ring and owns every slot until it names the
+// slot in a FRAME message; ownership returns with the matching RESULT. No
+// synchronization lives in shared memory, the socket orders all handoffs.
+//
+// The layout is read from the shared header once, when the ring is created or
+// opened. A peer that rewrites the header later cannot move the slots.
+class FrameRing {
+	public:
+		static FrameRing Create(std::string name, uint32_t slot_count, size_t slot_size);
+		static FrameRing Open(std::string name);
+
+		FrameRing(const FrameRing &other) = delete;
+		FrameRing(FrameRing &&other);
+		~FrameRing();
+
+		FrameRing &operator=(const FrameRing &other) = delete;
+		FrameRing &operator=(FrameRing &&other);
+
+		const std::string &name() const;
+		uint32_t slot_count() const;
+		size_t slot_size() const;
+
+		uint8_t *slot(uint32_t index);
+		const uint8_t *slot(uint32_t index) const;
+	private:
+		struct Header {
+			uint32_t magic;
+			uint32_t slot_count;
+			uint64_t slot_size;
+			uint64_t slots_offset;
+		};
+
+		std::string name_;
+		bool owner_;
+		void *mapping_;
+		size_t mapping_size_;
+		uint32_t slot_count_;
+		size_t slot_size_;
+		size_t slots_offset_;
+
+		FrameRing(
+			std::string name, bool owner, void *mapping, size_t mapping_size,
+			uint32_t slot_count, size_t slot_size, size_t slots_offset
+		);
+
+		void Release();
+};
+
+}	// namespace server
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_SERVER_FRAME_RING_H_
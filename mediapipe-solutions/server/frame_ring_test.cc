@@ -0,0 +1,137 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/server/frame_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+
+namespace mediapipe_solutions {
+namespace server {
+namespace {
+
+// Mirrors FrameRing's private header, which clients can write.
+struct RawHeader {
+	uint32_t magic;
+	uint32_t slot_count;
+	uint64_t slot_size;
+	uint64_t slots_offset;
+};
+
+string RingName(const string &test) {
+	return "/mediapipe-solutions-frame-ring-test-" + to_string(getpid()) + "-" + test;
+}
+
+// Rewrites the shared header of the ring name as a misbehaving client could.
+template <typename Change>
+void RewriteHeader(const string &name, Change change) {
+	const int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+	ASSERT_GE(fd, 0);
+
+	void *mapping = mmap(nullptr, sizeof(RawHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	close(fd);
+	ASSERT_NE(mapping, MAP_FAILED);
+
+	RawHeader header;
+
+	memcpy(&header, mapping, sizeof(header));
+	change(header);
+	memcpy(mapping, &header, sizeof(header));
+	munmap(mapping, sizeof(RawHeader));
+}
+
+TEST(FrameRingTest, OpenSeesTheCreatedLayout) {
+	auto created = FrameRing::Create(RingName("layout"), 3, 1000);
+	const auto opened = FrameRing::Open(created.name());
+
+	EXPECT_EQ(opened.slot_count(), 3u);
+	EXPECT_EQ(opened.slot_size(), created.slot_size());
+	EXPECT_GE(created.slot_size(), 1000u);
+
+	created.slot(2)[0] = 42;
+	EXPECT_EQ(opened.slot(2)[0], 42);
+	EXPECT_THROW(opened.slot(3), out_of_range);
+}
+
+TEST(FrameRingTest, RejectsWrongMagic) {
+	const auto created = FrameRing::Create(RingName("magic"), 2, 64);
+
+	RewriteHeader(created.name(), [](RawHeader &header) { header.magic = 0; });
+	EXPECT_THROW(FrameRing::Open(created.name()), runtime_error);
+}
+
+TEST(FrameRingTest, RejectsEmptySlots) {
+	const auto created = FrameRing::Create(RingName("empty"), 2, 64);
+
+	RewriteHeader(created.name(), [](RawHeader &header) { header.slot_size = 0; });
+	EXPECT_THROW(FrameRing::Open(created.name()), runtime_error);
+}
+
+TEST(FrameRingTest, RejectsSlotsPastTheMapping) {
+	const auto created = FrameRing::Create(RingName("past"), 2, 64);
+
+	RewriteHeader(created.name(), [](RawHeader &header) { ++header.slot_count; });
+	EXPECT_THROW(FrameRing::Open(created.name()), runtime_error);
+}
+
+TEST(FrameRingTest, RejectsOffsetOutsideTheMapping) {
+	const auto created = FrameRing::Create(RingName("offset"), 2, 64);
+
+	RewriteHeader(created.name(), [](RawHeader &header) { header.slots_offset = ~uint64_t(0) - 8; });
+	EXPECT_THROW(FrameRing::Open(created.name()), runtime_error);
+
+	RewriteHeader(created.name(), [](RawHeader &header) { header.slots_offset = 0; });
+	EXPECT_THROW(FrameRing::Open(created.name()), runtime_error);
+}
+
+TEST(FrameRingTest, RejectsSizesWhoseProductOverflows) {
+	const auto created = FrameRing::Create(RingName("overflow"), 2, 64);
+
+	// slot_count * slot_size wraps around to a small value.
+	RewriteHeader(created.name(), [](RawHeader &header) {
+		header.slot_count = 1u << 31;
+		header.slot_size = uint64_t(1) << 33;
+	});
+	EXPECT_THROW(FrameRing::Open(created.name()), runtime_error);
+}
+
+TEST(FrameRingTest, IgnoresHeaderChangesAfterOpen) {
+	const auto created = FrameRing::Create(RingName("after"), 2, 64);
+	const auto opened = FrameRing::Open(created.name());
+	const auto slotSize = opened.slot_size();
+
+	RewriteHeader(created.name(), [](RawHeader &header) {
+		header.slot_count = 1000;
+		header.slot_size = uint64_t(1) << 40;
+	});
+
+	EXPECT_EQ(opened.slot_count(), 2u);
+	EXPECT_EQ(opened.slot_size(), slotSize);
+	EXPECT_THROW(opened.slot(2), out_of_range);
+}
+
+}	// namespace
+}	// namespace server
+}	// namespace mediapipe_solutions
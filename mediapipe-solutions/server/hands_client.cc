@@ -0,0 +1,219 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/server/hands_client.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+	[[noreturn]] void ThrowErrno(const string &what) {
+		throw system_error(errno, generic_category(), what);
+	}
+
+	int Connect(const string &socket_path) {
+		sockaddr_un address {};
+
+		if (socket_path.size() >= sizeof(address.sun_path))
+			throw invalid_argument("Socket path too long: " + socket_path);
+
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+		const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+		if (fd < 0)
+			ThrowErrno("socket");
+
+		if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+			const int error = errno;
+			close(fd);
+			errno = error;
+			ThrowErrno("connect(" + socket_path + ")");
+		}
+
+		return fd;
+	}
+
+	string UniqueRingName() {
+		static atomic<unsigned> counter { 0 };
+
+		return "/mediapipe-solutions-" + to_string(getpid()) + "-" + to_string(counter++);
+	}
+}
+
+namespace mediapipe_solutions {
+namespace server {
+
+HandsClient::HandsClient(
+	const string &socket_path,
+	uint32_t slot_count, size_t slot_size,
+	int max_num_hands,
+	float min_detection_confidence, float min_tracking_confidence
+) :
+	socket_(Connect(socket_path)),
+	ring_(FrameRing::Create(UniqueRingName(), slot_count, slot_size)),
+	slot_in_flight_(slot_count, false) {
+	auto hello = MakeMessage<HelloMessage>(MessageType::HELLO);
+
+	hello.version = kProtocolVersion;
+	strncpy(hello.ring_name, ring_.name().c_str(), sizeof(hello.ring_name) - 1);
+	hello.max_num_hands = max_num_hands;
+	hello.min_detection_confidence = min_detection_confidence;
+	hello.min_tracking_confidence = min_tracking_confidence;
+
+	try {
+		Send(&hello, sizeof(hello));
+	}
+	catch (...) {
+		close(socket_);
+		throw;
+	}
+}
+
+HandsClient::~HandsClient() {
+	close(socket_);
+}
+
+optional<uint32_t> HandsClient::AcquireSlot() {
+	for (uint32_t slot = 0; slot < slot_in_flight_.size(); ++slot) {
+		if (!slot_in_flight_[slot])
+			return slot;
+	}
+
+	return nullopt;
+}
+
+uint8_t *HandsClient::SlotData(uint32_t slot) {
+	return ring_.slot(slot);
+}
+
+size_t HandsClient::slot_size() const {
+	return ring_.slot_size();
+}
+
+void HandsClient::Submit(
+	uint32_t slot, uint32_t format, int width, int height, int width_step,
+	microseconds client_timestamp
+) {
+	if (slot >= slot_in_flight_.size() or slot_in_flight_[slot])
+		throw invalid_argument("Slot is not available.");
+
+	if (width_step < 0 or height < 0 or size_t(width_step) * size_t(height) > ring_.slot_size())
+		throw out_of_range("Frame does not fit into a ring slot.");
+
+	auto frame = MakeMessage<FrameMessage>(MessageType::FRAME);
+
+	frame.slot = slot;
+	frame.format = format;
+	frame.width = width;
+	frame.height = height;
+	frame.width_step = width_step;
+	frame.client_timestamp_us = client_timestamp.count();
+
+	Send(&frame, sizeof(frame));
+	slot_in_flight_[slot] = true;
+}
+
+RemoteHandsResult HandsClient::Receive() {
+	alignas(ResultMessage) uint8_t buffer[kMaxMessageSize];
+	const auto size = ReceiveMessage(buffer, sizeof(buffer));
+	const auto &message = *reinterpret_cast<const ResultMessage *>(buffer);
+
+	if (message.header.type != MessageType::RESULT or size < sizeof(ResultMessage) or
+		size < sizeof(ResultMessage) + message.num_hands * sizeof(HandResult))
+		throw runtime_error("Malformed result message.");
+
+	RemoteHandsResult result;
+
+	result.slot = message.slot;
+	result.client_timestamp = microseconds(message.client_timestamp_us);
+	result.queue_time = microseconds(message.queue_us);
+	result.process_time = microseconds(message.process_us);
+
+	const auto *hands = reinterpret_cast<const HandResult *>(buffer + sizeof(ResultMessage));
+
+	for (uint32_t i = 0; i < message.num_hands; ++i) {
+		RemoteHand hand;
+
+		hand.handedness = hands[i].handedness;
+		memcpy(hand.landmarks.data(), hands[i].landmarks, sizeof(hands[i].landmarks));
+		result.hands.push_back(hand);
+	}
+
+	if (message.slot < slot_in_flight_.size())
+		slot_in_flight_[message.slot] = false;
+
+	return result;
+}
+
+StatsReplyMessage HandsClient::Stats() {
+	const auto request = MakeMessage<StatsMessage>(MessageType::STATS);
+	// Large enough for any reply, so that an ERROR is recognized as such.
+	alignas(StatsReplyMessage) uint8_t buffer[kMaxMessageSize];
+
+	Send(&request, sizeof(request));
+
+	// The server answers messages in order, so the results of frames submitted
+	// earlier arrive before the reply. Only ask for stats while no frame is in
+	// flight; those results would otherwise be consumed here.
+	const auto size = ReceiveMessage(buffer, sizeof(buffer));
+	const auto &reply = *reinterpret_cast<const StatsReplyMessage *>(buffer);
+
+	if (size != sizeof(StatsReplyMessage) or reply.header.type != MessageType::STATS_REPLY)
+		throw runtime_error("Malformed stats reply; are frames still in flight?");
+
+	return reply;
+}
+
+void HandsClient::Send(const void *message, size_t size) {
+	while (send(socket_, message, size, MSG_NOSIGNAL) < 0) {
+		if (errno != EINTR)
+			ThrowErrno("send");
+	}
+}
+
+size_t HandsClient::ReceiveMessage(void *buffer, size_t size) {
+	ssize_t received;
+
+	while ((received = recv(socket_, buffer, size, 0)) < 0) {
+		if (errno != EINTR)
+			ThrowErrno("recv");
+	}
+
+	if (received == 0)
+		throw runtime_error("Server closed the connection.");
+
+	const auto &header = *static_cast<const MessageHeader *>(buffer);
+
+	if (size_t(received) >= sizeof(ErrorMessage) and header.type == MessageType::ERROR) {
+		const auto &error = *static_cast<const ErrorMessage *>(buffer);
+		throw runtime_error(string(error.message, strnlen(error.message, sizeof(error.message))));
+	}
+
+	return size_t(received);
+}
+
+}	// namespace server
+}	// namespace mediapipe_solutions
@@ -0,0 +1,87 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_SERVER_HANDS_CLIENT_H_
+#define MEDIAPIPE_SOLUTIONS_SERVER_HANDS_CLIENT_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "frame_ring.h"
+#include "protocol.h"
+
+namespace mediapipe_solutions {
+namespace server {
+
+struct RemoteHand {
+	uint8_t handedness;	// mediapipe_solutions::Handedness
+	std::array<std::array<float, 3>, kNumHandLandmarks> landmarks;
+};
+
+struct RemoteHandsResult {
+	uint32_t slot;
+	std::chrono::microseconds client_timestamp;
+	std::chrono::microseconds queue_time;
+	std::chrono::microseconds process_time;
+	std::vector<RemoteHand> hands;
+};
+
+// Talks to hands-server. Frames are written straight into a slot of the
+// client's shared memory ring and only the slot index travels over the socket,
+// so the pixels are never copied between the two processes.
+//
+// Several frames may be in flight; every Submit is answered by exactly one
+// result, in submission order.
+class HandsClient {
+	public:
+		HandsClient(
+			const std::string &socket_path,
+			uint32_t slot_count = 4, size_t slot_size = 1920 * 1080 * 4,
+			int max_num_hands = 2,
+			float min_detection_confidence = 0.5, float min_tracking_confidence = 0.5
+		);
+
+		HandsClient(const HandsClient &other) = delete;
+		~HandsClient();
+
+		// Returns a free slot, or nullopt when all slots are in flight.
+		std::optional<uint32_t> AcquireSlot();
+		uint8_t *SlotData(uint32_t slot);
+		size_t slot_size() const;
+
+		// format is a mediapipe::ImageFormat::Format value.
+		void Submit(
+			uint32_t slot, uint32_t format, int width, int height, int width_step,
+			std::chrono::microseconds client_timestamp
+		);
+
+		RemoteHandsResult Receive();
+		StatsReplyMessage Stats();
+	private:
+		int socket_;
+		FrameRing ring_;
+		std::vector<bool> slot_in_flight_;
+
+		void Send(const void *message, size_t size);
+		size_t ReceiveMessage(void *buffer, size_t size);
+};
+
+}	// namespace server
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_SERVER_HANDS_CLIENT_H_
@@ -0,0 +1,480 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Local hand landmark server. Clients connect over a Unix domain socket, share
+// a FrameRing with the server and submit frames by slot index. The poll loop
+// only reads messages; every client has its own thread that creates its graph
+// and answers its messages in order, so a slow client never delays the
+// others. The client graphs may share one executor (--executor_threads).
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+#include "mediapipe-solutions/hands/hands.h"
+#include "mediapipe-solutions/server/frame_ring.h"
+#include "mediapipe-solutions/server/protocol.h"
+#include "mediapipe-solutions/util/latency_histogram.h"
+
+ABSL_FLAG(std::string, socket_path, "/tmp/mediapipe-solutions-hands.sock",
+	"Path of the Unix domain socket to listen on.");
+ABSL_FLAG(int, max_queued_messages, 64,
+	"Maximum number of messages queued per client. The server stops reading "
+	"from a client until its thread has caught up.");
+ABSL_FLAG(int, executor_threads, -1,
+	"Threads of the pool shared by all client graphs; 0 uses one per core. "
+	"Negative gives every client graph its own threads.");
+
+using namespace std;
+using namespace std::chrono;
+using namespace mediapipe;
+using namespace mediapipe_solutions;
+using namespace mediapipe_solutions::server;
+
+namespace {
+	volatile sig_atomic_t stop_requested = 0;
+
+	// Shared by the graphs of all clients, unless disabled.
+	shared_ptr<WorkStealingExecutor> executor;
+
+	struct Message {
+		vector<uint8_t> bytes;
+		steady_clock::time_point received;
+	};
+
+	struct Client {
+		int fd = -1;
+		// Set by either thread; the client thread then stops and the poll loop
+		// reaps the client.
+		atomic<bool> closing { false };
+		atomic<bool> done { false };
+
+		mutex messages_mutex;
+		condition_variable wake;
+		deque<Message> messages;
+
+		thread worker;
+
+		// Only touched by the client thread until done.
+		optional<FrameRing> ring;
+		unique_ptr<Hands> hands;
+		uint64_t frames = 0;
+		uint64_t drained_groups = 0;
+		LatencyHistogram queue_latency;
+		LatencyHistogram process_latency;
+		LatencyHistogram total_latency;
+	};
+
+	LatencySummary Summarize(const LatencyHistogram &histogram) {
+		LatencySummary summary;
+
+		summary.count = histogram.count();
+		summary.mean_us = histogram.mean().count();
+		summary.p50_us = histogram.Percentile(50).count();
+		summary.p99_us = histogram.Percentile(99).count();
+		summary.max_us = histogram.max().count();
+		return summary;
+	}
+
+	void Send(Client &client, const void *message, size_t size) {
+		while (send(client.fd, message, size, MSG_NOSIGNAL) < 0) {
+			if (errno != EINTR) {
+				client.closing = true;
+				return;
+			}
+		}
+	}
+
+	// Stops the client thread after the message it is handling.
+	void RequestClose(Client &client) {
+		{
+			lock_guard<mutex> lock(client.messages_mutex);
+			client.closing = true;
+		}
+
+		client.wake.notify_one();
+	}
+
+	void SendError(Client &client, const string &what) {
+		auto error = MakeMessage<ErrorMessage>(MessageType::ERROR);
+
+		strncpy(error.message, what.c_str(), sizeof(error.message) - 1);
+		Send(client, &error, sizeof(error));
+		client.closing = true;
+	}
+
+	int Listen(const string &socket_path) {
+		sockaddr_un address {};
+
+		if (socket_path.size() >= sizeof(address.sun_path))
+			throw invalid_argument("Socket path too long: " + socket_path);
+
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+		unlink(socket_path.c_str());
+
+		const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+		if (fd < 0)
+			throw system_error(errno, generic_category(), "socket");
+
+		if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 or
+			listen(fd, SOMAXCONN) != 0) {
+			const int error = errno;
+
+			close(fd);
+			throw system_error(error, generic_category(), "listen(" + socket_path + ")");
+		}
+
+		return fd;
+	}
+
+	// Bytes per pixel of the formats the hands graph accepts.
+	optional<size_t> BytesPerPixel(uint32_t format) {
+		switch (ImageFormat::Format(format)) {
+			case ImageFormat::SRGB:
+				return 3;
+			case ImageFormat::SRGBA:
+				return 4;
+			default:
+				return nullopt;
+		}
+	}
+
+	// The returned frame calls released once the graph has dropped it.
+	unique_ptr<ImageFrame> WrapSlot(const Client &client, const FrameMessage &message, function<void()> released) {
+		const auto &ring = *client.ring;
+		const auto bytesPerPixel = BytesPerPixel(message.format);
+
+		// ImageFrame aborts the process on formats it does not know.
+		if (!bytesPerPixel)
+			throw invalid_argument("Unsupported image format " + to_string(message.format) + ".");
+
+		if (message.width <= 0 or message.height <= 0 or
+			size_t(message.width_step) < size_t(message.width) * *bytesPerPixel)
+			throw invalid_argument("Frame rows are shorter than their pixels.");
+
+		if (size_t(message.width_step) * size_t(message.height) > ring.slot_size())
+			throw out_of_range("Frame does not fit into its ring slot.");
+
+		// The graph only reads its input, so the slot backs the ImageFrame
+		// directly.
+		return make_unique<ImageFrame>(
+			ImageFormat::Format(message.format), message.width, message.height, message.width_step,
+			const_cast<uint8 *>(ring.slot(message.slot)),
+			[released](uint8 *) { released(); }
+		);
+	}
+
+	void HandleHello(Client &client, const HelloMessage &hello) {
+		if (hello.version != kProtocolVersion)
+			throw runtime_error("Unsupported protocol version.");
+
+		if (client.hands)
+			throw runtime_error("Duplicate HELLO.");
+
+		client.ring = FrameRing::Open(string(hello.ring_name, strnlen(hello.ring_name, sizeof(hello.ring_name))));
+		client.hands = make_unique<Hands>(
+			clamp(hello.max_num_hands, 0, int(kMaxHands)),
+			hello.min_detection_confidence, hello.min_tracking_confidence,
+			1, ExecutionOptions { executor, "client" + to_string(client.fd) }
+		);
+	}
+
+	void HandleFrame(Client &client, const FrameMessage &frame, steady_clock::time_point received) {
+		if (!client.hands)
+			throw runtime_error("FRAME before HELLO.");
+
+		const auto started = steady_clock::now();
+		// Outlives this call if Process throws while the graph holds the frame.
+		const auto released = make_shared<promise<void>>();
+		const auto hands = client.hands->ProcessAllHands(WrapSlot(client, frame, [released]() { released->set_value(); }));
+
+		// Process returns once the outputs are assembled, which can be before
+		// the graph has dropped its input. The client reuses the slot as soon
+		// as it has the result.
+		released->get_future().wait();
+
+		const auto finished = steady_clock::now();
+
+		alignas(ResultMessage) uint8_t buffer[kMaxMessageSize] {};
+		auto &result = *reinterpret_cast<ResultMessage *>(buffer);
+		auto *handResults = reinterpret_cast<HandResult *>(buffer + sizeof(ResultMessage));
+
+		result.header.type = MessageType::RESULT;
+		result.slot = frame.slot;
+		result.client_timestamp_us = frame.client_timestamp_us;
+		result.queue_us = duration_cast<microseconds>(started - received).count();
+		result.process_us = duration_cast<microseconds>(finished - started).count();
+
+		for (const auto &hand : hands) {
+			if (result.num_hands == kMaxHands)
+				break;
+
+			auto &handResult = handResults[result.num_hands++];
+			const auto landmarkCount = min(size_t(hand.second.landmark_size()), kNumHandLandmarks);
+
+			handResult.handedness = uint8_t(hand.first);
+
+			for (size_t i = 0; i < landmarkCount; ++i) {
+				const auto &landmark = hand.second.landmark(int(i));
+
+				handResult.landmarks[i][0] = landmark.x();
+				handResult.landmarks[i][1] = landmark.y();
+				handResult.landmarks[i][2] = landmark.z();
+			}
+		}
+
+		result.header.size = uint32_t(sizeof(ResultMessage) + result.num_hands * sizeof(HandResult));
+		Send(client, buffer, result.header.size);
+
+		++client.frames;
+		client.queue_latency.Record(duration_cast<microseconds>(started - received));
+		client.process_latency.Record(duration_cast<microseconds>(finished - started));
+		client.total_latency.Record(duration_cast<microseconds>(finished - received));
+	}
+
+	void HandleStats(Client &client) {
+		auto reply = MakeMessage<StatsReplyMessage>(MessageType::STATS_REPLY);
+
+		reply.frames = client.frames;
+		reply.drained_groups = client.drained_groups;
+		reply.queue = Summarize(client.queue_latency);
+		reply.process = Summarize(client.process_latency);
+		reply.total = Summarize(client.total_latency);
+		Send(client, &reply, sizeof(reply));
+	}
+
+	template <typename T>
+	const T &MessageAs(const Message &message, const char *name) {
+		if (message.bytes.size() < sizeof(T))
+			throw runtime_error("Truncated "s + name + ".");
+
+		return *reinterpret_cast<const T *>(message.bytes.data());
+	}
+
+	void HandleMessage(Client &client, const Message &message) {
+		const auto &header = MessageAs<MessageHeader>(message, "message");
+
+		switch (header.type) {
+			case MessageType::HELLO:
+				HandleHello(client, MessageAs<HelloMessage>(message, "HELLO"));
+				break;
+			case MessageType::FRAME:
+				HandleFrame(client, MessageAs<FrameMessage>(message, "FRAME"), message.received);
+				break;
+			case MessageType::STATS:
+				HandleStats(client);
+				break;
+			default:
+				throw runtime_error("Unexpected message type.");
+		}
+	}
+
+	// The client's thread. Takes everything queued at once and answers it in
+	// order; each such group is counted in drained_groups.
+	void ServeClient(Client &client) {
+		while (!client.closing) {
+			deque<Message> messages;
+
+			{
+				unique_lock<mutex> lock(client.messages_mutex);
+
+				client.wake.wait(lock, [&client]() { return client.closing or !client.messages.empty(); });
+				messages.swap(client.messages);
+			}
+
+			if (!messages.empty())
+				++client.drained_groups;
+
+			for (const auto &message : messages) {
+				if (client.closing)
+					break;
+
+				try {
+					HandleMessage(client, message);
+				}
+				catch (const exception &e) {
+					SendError(client, e.what());
+				}
+			}
+		}
+
+		if (client.hands)
+			client.hands->Close();
+
+		client.done = true;
+	}
+
+	// Reads every message the client has queued without blocking, up to
+	// max_queued messages waiting for the client thread.
+	void Drain(Client &client, size_t max_queued) {
+		alignas(HelloMessage) uint8_t buffer[kMaxMessageSize];
+
+		while (!client.closing) {
+			{
+				lock_guard<mutex> lock(client.messages_mutex);
+
+				if (client.messages.size() >= max_queued)
+					return;
+			}
+
+			const auto received = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+			if (received < 0 and errno == EINTR)
+				continue;
+
+			if (received < 0 and (errno == EAGAIN or errno == EWOULDBLOCK))
+				return;
+
+			if (received <= 0) {
+				RequestClose(client);
+				return;
+			}
+
+			{
+				lock_guard<mutex> lock(client.messages_mutex);
+
+				client.messages.push_back({ vector<uint8_t>(buffer, buffer + received), steady_clock::now() });
+			}
+
+			client.wake.notify_one();
+		}
+	}
+
+	bool Full(Client &client, size_t max_queued) {
+		lock_guard<mutex> lock(client.messages_mutex);
+
+		return client.messages.size() >= max_queued;
+	}
+
+	void Stop(Client &client) {
+		RequestClose(client);
+
+		if (client.worker.joinable())
+			client.worker.join();
+	}
+
+	void LogStats(const Client &client) {
+		const auto total = Summarize(client.total_latency);
+
+		cerr << "Client " << client.fd << ": " << client.frames << " frames in " << client.drained_groups << " drained groups, "
+			<< "latency mean " << total.mean_us << "us p50 " << total.p50_us << "us p99 " << total.p99_us << "us"
+			<< endl;
+	}
+}
+
+int main(int argc, char **argv) {
+	absl::ParseCommandLine(argc, argv);
+
+	const auto socket_path = absl::GetFlag(FLAGS_socket_path);
+	const auto max_queued = size_t(max(absl::GetFlag(FLAGS_max_queued_messages), 1));
+	const int listener = Listen(socket_path);
+
+	if (absl::GetFlag(FLAGS_executor_threads) >= 0)
+		executor = WorkStealingExecutor::Create(absl::GetFlag(FLAGS_executor_threads));
+
+	signal(SIGINT, [](int) { stop_requested = 1; });
+	signal(SIGTERM, [](int) { stop_requested = 1; });
+
+	list<Client> clients;
+
+	while (!stop_requested) {
+		vector<pollfd> fds;
+		vector<Client *> polled;
+
+		fds.push_back({ listener, POLLIN, 0 });
+
+		// Clients with a full queue are not read until their thread catches up.
+		for (auto &client : clients) {
+			if (client.closing or Full(client, max_queued))
+				continue;
+
+			fds.push_back({ client.fd, POLLIN, 0 });
+			polled.push_back(&client);
+		}
+
+		// Wakes up regularly to reap finished clients and to resume reading from
+		// clients whose queue has drained.
+		if (poll(fds.data(), fds.size(), 100) < 0) {
+			if (errno == EINTR)
+				continue;
+
+			throw system_error(errno, generic_category(), "poll");
+		}
+
+		if (fds.front().revents & POLLIN) {
+			const int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+
+			if (fd >= 0) {
+				auto &client = clients.emplace_back();
+
+				client.fd = fd;
+				client.worker = thread(ServeClient, ref(client));
+			}
+		}
+
+		for (size_t i = 0; i < polled.size(); ++i) {
+			if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+				Drain(*polled[i], max_queued);
+		}
+
+		for (auto client = clients.begin(); client != clients.end();) {
+			if (client->done) {
+				Stop(*client);
+				LogStats(*client);
+				close(client->fd);
+				client = clients.erase(client);
+			}
+			else
+				++client;
+		}
+	}
+
+	for (auto &client : clients) {
+		Stop(client);
+		LogStats(client);
+		close(client.fd);
+	}
+
+	close(listener);
+	unlink(socket_path.c_str());
+
+	return EXIT_SUCCESS;
+}
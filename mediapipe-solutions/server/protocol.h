@@ -0,0 +1,131 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_SERVER_PROTOCOL_H_
+#define MEDIAPIPE_SOLUTIONS_SERVER_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Wire format spoken between hands-server and HandsClient over a
+// SOCK_SEQPACKET Unix domain socket. Both ends always run on the same host, so
+// messages are plain structs in native layout. Pixel data never crosses the
+// socket; FRAME messages only name a slot of the client's FrameRing.
+
+namespace mediapipe_solutions {
+namespace server {
+
+constexpr uint32_t kProtocolVersion = 1;
+constexpr size_t kNumHandLandmarks = 21;
+constexpr size_t kMaxRingNameLength = 64;
+
+enum class MessageType : uint32_t {
+	HELLO = 1,
+	FRAME = 2,
+	RESULT = 3,
+	STATS = 4,
+	STATS_REPLY = 5,
+	ERROR = 6,
+};
+
+struct MessageHeader {
+	MessageType type;
+	uint32_t size;	// Total message size including this header.
+};
+
+// First message of every connection; the server maps the named ring and
+// creates the graph for this client.
+struct HelloMessage {
+	MessageHeader header;
+	uint32_t version;
+	char ring_name[kMaxRingNameLength];
+	int32_t max_num_hands;
+	float min_detection_confidence;
+	float min_tracking_confidence;
+};
+
+struct FrameMessage {
+	MessageHeader header;
+	uint32_t slot;
+	uint32_t format;	// mediapipe::ImageFormat::Format
+	int32_t width;
+	int32_t height;
+	int32_t width_step;
+	int64_t client_timestamp_us;
+};
+
+struct HandResult {
+	uint8_t handedness;	// mediapipe_solutions::Handedness
+	uint8_t reserved[3];
+	float landmarks[kNumHandLandmarks][3];
+};
+
+// Followed by num_hands HandResult entries.
+struct ResultMessage {
+	MessageHeader header;
+	uint32_t slot;
+	uint32_t num_hands;
+	int64_t client_timestamp_us;
+	int64_t queue_us;
+	int64_t process_us;
+};
+
+struct StatsMessage {
+	MessageHeader header;
+};
+
+struct LatencySummary {
+	uint64_t count;
+	int64_t mean_us;
+	int64_t p50_us;
+	int64_t p99_us;
+	int64_t max_us;
+};
+
+struct StatsReplyMessage {
+	MessageHeader header;
+	uint64_t frames;
+	// Times the client's thread took all queued messages at once; frames per
+	// group above 1 mean the thread fell behind.
+	uint64_t drained_groups;
+	LatencySummary queue;
+	LatencySummary process;
+	LatencySummary total;
+};
+
+struct ErrorMessage {
+	MessageHeader header;
+	char message[256];
+};
+
+// Most hands in a RESULT; the server clamps HELLO's max_num_hands to it.
+constexpr size_t kMaxHands = 16;
+constexpr size_t kMaxMessageSize = sizeof(ResultMessage) + kMaxHands * sizeof(HandResult);
+
+static_assert(kMaxMessageSize >= sizeof(ErrorMessage) and kMaxMessageSize >= sizeof(StatsReplyMessage) and
+	kMaxMessageSize >= sizeof(HelloMessage), "Receive buffers must hold every message.");
+
+template <typename T>
+inline T MakeMessage(MessageType type) {
+	T message {};
+
+	message.header.type = type;
+	message.header.size = sizeof(T);
+	return message;
+}
+
+}	// namespace server
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_SERVER_PROTOCOL_H_
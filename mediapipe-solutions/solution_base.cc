@@ -14,9 +14,13 @@
 
 #include "mediapipe-solutions/solution_base.h"
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
-#include "absl/strings/str_split.h"
+#include <future>
+#include <set>
+#include <thread>
 
 #include "mediapipe/framework/formats/classification.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
@@ -26,139 +30,42 @@
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 
+#include "mediapipe-solutions/util/numa.h"
 #include "mediapipe-solutions/util/util.h"
 
 using namespace std;
 using namespace std::chrono;
-using namespace google::protobuf;
 using namespace mediapipe;
 
 namespace {
+	// Results that may be in flight at once.
+	constexpr int kResultCapacity = 64;
+
+	// How often the error watch polls while frames are pending.
+	constexpr auto kErrorPollInterval = std::chrono::milliseconds(10);
+
+	struct ErrorWatch {
+		std::mutex mutex;
+		// Signaled when a solution gets its first pending frame.
+		std::condition_variable wake;
+		// Signaled when the watch has finished a failed solution.
+		std::condition_variable finished;
+		std::set<mediapipe_solutions::SolutionBase *> solutions;
+		mediapipe_solutions::SolutionBase *finishing = nullptr;
+		std::thread::id thread;
+	};
+
+	// Never destroyed, since its thread runs until the process exits.
+	ErrorWatch &GetErrorWatch() {
+		static auto *watch = new ErrorWatch();
+
+		return *watch;
+	}
+
 	template <typename Rep, typename Period>
 	inline mediapipe::Timestamp ToTimestamp(std::chrono::duration<Rep, Period> value) {
 		return mediapipe::Timestamp(std::chrono::duration_cast<std::chrono::microseconds>(value).count());
 	}
-
-	// TODO: Enable calculator options modification for more calculators.
-	/*
-	void CreateOptions(CalculatorGraphConfig::Node &node)
-	{
-		std::string_view calculator = node.calculator();
-
-		if (calculator == "ConstantSidePacketCalculator")
-			node.set_allocated_options(new ConstantSidePacketCalculatorOptions());
-		else if (calculator == "ImageTransformationCalculator")
-			node.set_allocated_options(new ImageTransformationCalculatorOptions());
-		else if (calculator == "LandmarksSmoothingCalculator")
-			node.set_allocated_options(new LandmarksSmoothingCalculatorOptions());
-		else if (calculator == "LogicCalculator")
-			node.set_allocated_options(new LogicCalculatorOptions());
-		else if (calculator == "ThresholdingCalculator")
-			node.set_allocated_options(new ThresholdingCalculatorOptions());
-		else if (calculator == "TensorsToDetectionsCalculator")
-			node.set_allocated_options(new TensorsToDetectionsCalculatorOptions());
-		else if (calculator == "Lift2DFrameAnnotationTo3DCalculator")
-			node.set_allocated_options(new Lift2DFrameAnnotationTo3DCalculatorOptions());
-		else
-			throw logic_error("Modifying the calculator options of "s + string(calculator) + " is not supported.");
-	}
-	*/
-
-	void SetField(Message *message, const FieldDescriptor *field, any &&value) {
-		const auto &reflection = message->GetReflection();
-
-		if (field->is_repeated()) {
-			switch (field->cpp_type()) {
-				case FieldDescriptor::CppType::CPPTYPE_INT32:
-					reflection->AddInt32(message, field, any_cast<int32_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_INT64:
-					reflection->AddInt64(message, field, any_cast<int64_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_UINT32:
-					reflection->AddUInt32(message, field, any_cast<uint32_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_UINT64:
-					reflection->AddUInt64(message, field, any_cast<uint64_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_DOUBLE:
-					reflection->AddDouble(message, field, any_cast<double>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_FLOAT:
-					reflection->AddFloat(message, field, any_cast<float>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_BOOL:
-					reflection->AddBool(message, field, any_cast<bool>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_ENUM:
-					// TODO: Also try AddEnum EnumValueDescriptor
-					reflection->AddEnumValue(message, field, any_cast<int>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_STRING:
-					reflection->AddString(message, field, any_cast<string>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_MESSAGE:
-					reflection->AddAllocatedMessage(message, field, any_cast<Message *>(move(value)));
-					break;
-			}
-		}
-		else {
-			switch (field->cpp_type()) {
-				case FieldDescriptor::CppType::CPPTYPE_INT32:
-					reflection->SetInt32(message, field, any_cast<int32_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_INT64:
-					reflection->SetInt64(message, field, any_cast<int64_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_UINT32:
-					reflection->SetUInt32(message, field, any_cast<uint32_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_UINT64:
-					reflection->SetUInt64(message, field, any_cast<uint64_t>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_DOUBLE:
-					reflection->SetDouble(message, field, any_cast<double>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_FLOAT:
-					reflection->SetFloat(message, field, any_cast<float>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_BOOL:
-					reflection->SetBool(message, field, any_cast<bool>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_ENUM:
-					// TODO: Also try SetEnum EnumValueDescriptor
-					reflection->SetEnumValue(message, field, any_cast<int>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_STRING:
-					reflection->SetString(message, field, any_cast<string>(value));
-					break;
-				case FieldDescriptor::CppType::CPPTYPE_MESSAGE:
-					reflection->SetAllocatedMessage(message, any_cast<Message *>(move(value)), field);
-					break;
-			}
-		}
-	}
-
-	void SetField(Message *message, const string &field, any &&value) {
-		const auto &reflection = message->GetReflection();
-
-		unordered_map<string, const FieldDescriptor *> fields;
-
-		{
-			vector<const FieldDescriptor *> fieldsList;
-			reflection->ListFields(*message, &fieldsList);
-
-			for (const auto fieldDescriptor : fieldsList)
-				fields.emplace(fieldDescriptor->name(), fieldDescriptor);
-		}
-
-		if (fields.count(field))
-			SetField(message, fields.at(field), move(value));
-		else if (fields.count("ext"))
-			SetField(reflection->MutableMessage(message, fields.at("ext")), field, move(value));
-		else
-			throw out_of_range("Field \'" + field + "\' not found.");
-	}
 }
 
 namespace mediapipe_solutions {
@@ -167,22 +74,25 @@ SolutionBase::SolutionBase(
 	CalculatorGraphConfig graph_config,
 	unordered_map<string, Any> &&side_inputs,
 	vector<string> outputs,
-	unordered_map<string, any> options
+	vector<CalculatorOption> options,
+	ExecutionOptions execution
 ) {
-	Init(move(graph_config), move(side_inputs), move(outputs), move(options));
+	Init(move(graph_config), move(side_inputs), move(outputs), move(options), move(execution));
 }
 
 SolutionBase::SolutionBase(
 	string_view graph_config,
 	unordered_map<string, Any> &&side_inputs,
 	vector<string> outputs,
-	unordered_map<string, any> options
+	vector<CalculatorOption> options,
+	ExecutionOptions execution
 ) :
 	SolutionBase(
 		mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(string(graph_config)),
 		move(side_inputs),
 		move(outputs),
-		move(options)
+		move(options),
+		move(execution)
 	) {
 }
 
@@ -190,47 +100,69 @@ void SolutionBase::Init(
 	CalculatorGraphConfig graph_config,
 	unordered_map<string, Any> side_inputs,
 	vector<string> outputs,
-	unordered_map<string, any> options
+	vector<CalculatorOption> options,
+	ExecutionOptions execution
 ) {
-	ValidatedGraphConfig validated_graph_config;
-	validated_graph_config.Initialize(graph_config);
-	graph_config = validated_graph_config.Config();
+	// Precompiled configs arrive already expanded; only text configs pay for
+	// the subgraph expansion here.
+	if (!IsGraphConfigExpanded(graph_config))
+		graph_config = ExpandGraphConfig(graph_config);
 
-	unordered_map<string, unordered_map<string, any>> optionsUnflattened;
+	unordered_map<string, vector<const CalculatorOption *>> optionsByNode;
 
-	for (auto &option : options) {
-		vector<string> splitName = absl::StrSplit(option.first, '.');
-		optionsUnflattened[move(splitName.at(0))].emplace(move(splitName.at(1)), move(option.second));
-	}
+	for (const auto &option : options)
+		optionsByNode[option.node()].push_back(&option);
 
 	for (auto &node : *(graph_config.mutable_node())) {
-		const auto &nodeName = node.name();
+		auto nodeOptions = optionsByNode.find(node.name());
 
-		if (optionsUnflattened.count(nodeName)) {
-			if (!node.has_options())
-				throw out_of_range("Node is missing options.");
+		if (nodeOptions != optionsByNode.end()) {
+			for (const auto *option : nodeOptions->second)
+				option->Apply(node);
 
-			auto *nodeOptions = node.mutable_options();
+			optionsByNode.erase(nodeOptions);
+		}
+	}
 
-			for (auto &option : optionsUnflattened.at(nodeName))
-				SetField(nodeOptions, option.first, move(option.second));
+	if (!optionsByNode.empty())
+		throw out_of_range("No such node: " + optionsByNode.begin()->first);
 
-			optionsUnflattened.erase(nodeName);
-		}
+	numa_node_ = execution.numa_node;
+
+	if (execution.cpus.empty() and execution.numa_node >= 0)
+		execution.cpus = CpusOfNumaNode(execution.numa_node);
+
+	// A private pool, since the graph's default executor cannot be pinned.
+	if (!execution.executor and !execution.cpus.empty())
+		execution.executor = WorkStealingExecutor::Create(0, 4, move(execution.cpus));
+
+	if (execution.executor) {
+		executor_ = move(execution.executor);
+		graph_executor_ = executor_->CreateGraphExecutor(move(execution.name));
+
+		// Replaces the default executor, so the graph starts no threads.
+		ThrowIfNotOk(graph_.SetExecutor("", graph_executor_));
 	}
 
-	if (!optionsUnflattened.empty())
-		throw out_of_range("No such node(s) exists.");
+	const auto &inputStreams = graph_config.input_stream();
+
+	deadline_counters_ = make_shared<DeadlineCounters>();
+	deadline_stream_ = find(inputStreams.begin(), inputStreams.end(), kDeadlineStream) != inputStreams.end();
 
-	graph_.Initialize(graph_config);
+	ThrowIfNotOk(graph_.Initialize(graph_config));
 	start_timestamp_ = steady_clock::now();
 
-	for (const auto &output : outputs) {
-		graph_outputs_.emplace(output, Packet());
-		graph_.ObserveOutputStream(
-			output,
-			[this, output](auto &&output_packet) { graph_outputs_.at(output) = output_packet; return absl::OkStatus(); }
-		);
+	outputs_ = move(outputs);
+	results_ = make_unique<ResultAssembler>(outputs_.size(), kResultCapacity);
+
+	// Timestamp bounds settle outputs that produce nothing for a frame, e.g.
+	// landmarks when no hand is found.
+	for (size_t i = 0; i < outputs_.size(); ++i) {
+		ThrowIfNotOk(graph_.ObserveOutputStream(
+			outputs_[i],
+			[this, i](const Packet &output_packet) { results_->Add(i, output_packet); return absl::OkStatus(); },
+			/*observe_timestamp_bounds=*/true
+		));
 	}
 
 	map<string, Packet> input_side_packets;
@@ -243,39 +175,242 @@ void SolutionBase::Init(
 		input_side_packets.emplace(name, move(nameDataPair.second).At(timestamp));
 	}
 
+	if (deadline_stream_)
+		input_side_packets.emplace(kDeadlineCountersSidePacket, MakePacket<shared_ptr<DeadlineCounters>>(deadline_counters_).At(timestamp));
+
 	ThrowIfNotOk(graph_.StartRun(input_side_packets));
+	Watch();
+}
+
+// Waits for the graph, so that no task of it is left on a shared executor
+// and every pending callback has run before the members are gone.
+SolutionBase::~SolutionBase() {
+	Close();
 }
 
 void SolutionBase::Close() {
+	Unwatch();
+
+	{
+		lock_guard<mutex> lock(submit_mutex_);
+
+		if (finished_)
+			return;
+	}
+
 	graph_.CloseAllPacketSources();
-	graph_.WaitUntilDone();
-	graph_outputs_.clear();
+	Finish(graph_.WaitUntilDone());
 }
 
-unordered_map<string, Any> SolutionBase::Process(unordered_map<string_view, Any> &&inputs) {
-	const auto timestamp = ToTimestamp(steady_clock::now() - start_timestamp_);
+void SolutionBase::WatchForErrors() {
+	auto &watch = GetErrorWatch();
+	unique_lock<mutex> lock(watch.mutex);
+
+	for (;;) {
+		SolutionBase *failed = nullptr;
+		bool pending = false;
+
+		for (auto *solution : watch.solutions) {
+			if (solution->pending_.load(memory_order_acquire) == 0)
+				continue;
+
+			pending = true;
+
+			if (solution->graph_.HasError()) {
+				failed = solution;
+				break;
+			}
+		}
+
+		if (!failed) {
+			if (pending)
+				watch.wake.wait_for(lock, kErrorPollInterval);
+			else
+				watch.wake.wait(lock);
+
+			continue;
+		}
+
+		watch.solutions.erase(failed);
+		watch.finishing = failed;
+		lock.unlock();
+
+		// Not under submit_mutex_, since graph threads may be waiting for it
+		// in Submit.
+		failed->Finish(failed->graph_.WaitUntilDone());
+
+		lock.lock();
+		watch.finishing = nullptr;
+		watch.finished.notify_all();
+	}
+}
+
+void SolutionBase::Watch() {
+	auto &watch = GetErrorWatch();
+	lock_guard<mutex> lock(watch.mutex);
+
+	if (watch.thread == thread::id()) {
+		thread watcher(&SolutionBase::WatchForErrors);
+
+		watch.thread = watcher.get_id();
+		watcher.detach();
+	}
+
+	watch.solutions.insert(this);
+}
+
+void SolutionBase::Unwatch() {
+	auto &watch = GetErrorWatch();
+	unique_lock<mutex> lock(watch.mutex);
+
+	watch.solutions.erase(this);
+
+	// Close may be called from a callback the watch runs.
+	if (watch.thread != this_thread::get_id())
+		watch.finished.wait(lock, [this, &watch]() { return watch.finishing != this; });
+}
+
+void SolutionBase::Finish(absl::Status status) {
+	{
+		lock_guard<mutex> lock(submit_mutex_);
+
+		// Fails the flushed results unless the graph closed cleanly.
+		done_status_ = move(status);
+		finished_ = true;
+	}
+
+	// Nothing is begun any more. The callbacks run unlocked, since they may
+	// submit again.
+	results_->Flush();
+}
+
+optional<GraphExecutorStats> SolutionBase::executor_stats() const {
+	if (!graph_executor_)
+		return nullopt;
+
+	return graph_executor_->Stats();
+}
+
+map<string, uint64_t> SolutionBase::deadline_expirations() const {
+	return deadline_counters_->Snapshot();
+}
+
+unique_ptr<ImageFrame> SolutionBase::CreateFrame(ImageFormat::Format format, int width, int height) const {
+	if (numa_node_ >= 0)
+		return CreateImageFrameOnNumaNode(format, width, height, numa_node_);
+
+	auto frame = make_unique<ImageFrame>(format, width, height, ImageFrame::kDefaultAlignmentBoundary);
+
+	frame->SetToZero();
+	return frame;
+}
+
+unordered_map<string, Any> SolutionBase::Process(unordered_map<string_view, Any> &&inputs, Deadline deadline) {
+	// Shared with the callback, which may still run if submitting fails.
+	auto result = make_shared<promise<absl::StatusOr<unordered_map<string, Any>>>>();
+	auto future = result->get_future();
+
+	ThrowIfNotOk(Submit(
+		move(inputs),
+		[result](absl::StatusOr<unordered_map<string, Any>> &&outputs) { result->set_value(move(outputs)); },
+		deadline
+	));
+
+	// Also fulfilled with the graph's error if it fails.
+	auto outputs = future.get();
+
+	ThrowIfNotOk(outputs.status());
+	return move(*outputs);
+}
+
+absl::Status SolutionBase::Submit(
+	unordered_map<string_view, Any> &&inputs,
+	Callback callback,
+	Deadline deadline
+) {
+	const auto deadlineValue = ToDeadlineValue(deadline);
+
+	// Not worth a timestamp, and sending it would only delay the next frame.
+	if (DeadlinePassed(deadlineValue)) {
+		deadline_counters_->Increment("submit");
+		return absl::DeadlineExceededError("The frame expired before it was submitted.");
+	}
+
+	lock_guard<mutex> lock(submit_mutex_);
+
+	// Frames begun before are settled by Finish; later ones never would be.
+	if (finished_)
+		return done_status_.ok() ? absl::FailedPreconditionError("The graph is closed.") : done_status_;
+
+	const auto timestamp = NextTimestamp();
+
+	// Takes the watch's lock on the first pending frame, so that the watch
+	// cannot miss it between checking and going to sleep.
+	if (pending_.fetch_add(1, memory_order_acq_rel) == 0) {
+		auto &watch = GetErrorWatch();
+
+		lock_guard<mutex> watchLock(watch.mutex);
+		watch.wake.notify_one();
+	}
+
+	results_->Begin(timestamp, [this, deadlineValue, callback = move(callback)](Timestamp frameTimestamp, vector<Packet> &&packets) {
+		pending_.fetch_sub(1, memory_order_acq_rel);
+
+		// Taken on every path, so that the frames of a failed or closed graph
+		// are forgotten as well.
+		const bool dropped = deadline_counters_->TakeDropped(frameTimestamp.Value());
+
+		// Only set once the graph failed, for the results Close flushes.
+		if (!done_status_.ok()) {
+			callback(done_status_);
+			return;
+		}
+
+		// Also the case for frames a gate dropped, whose outputs are empty.
+		// Those are already counted by the gate.
+		if (DeadlinePassed(deadlineValue)) {
+			if (!dropped)
+				deadline_counters_->Increment("output");
+
+			callback(absl::DeadlineExceededError("The frame missed its deadline."));
+			return;
+		}
+
+		unordered_map<string, Any> outputs;
+
+		for (size_t i = 0; i < outputs_.size(); ++i) {
+			if (!packets[i].IsEmpty())
+				outputs.emplace(outputs_[i], move(packets[i]));
+		}
+
+		callback(move(outputs));
+	});
+
+	if (deadline_stream_)
+		ThrowIfNotOk(graph_.AddPacketToInputStream(kDeadlineStream, MakePacket<int64_t>(deadlineValue).At(timestamp)));
 
 	for (auto &&input : inputs) {
 		ThrowIfNotOk(graph_.AddPacketToInputStream(string(input.first), move(input.second).At(timestamp)));
 	}
 
-	unordered_map<string, Any> outputs;
+	return absl::OkStatus();
+}
 
-	ThrowIfNotOk(graph_.WaitUntilIdle());
+Timestamp SolutionBase::NextTimestamp() {
+	auto timestamp = ToTimestamp(steady_clock::now() - start_timestamp_);
 
-	for (auto &&output : graph_outputs_) {
-		if (!output.second.IsEmpty())
-			outputs.emplace(output.first, move(output.second));
-	}
+	if (timestamp <= last_timestamp_)
+		timestamp = last_timestamp_ + TimestampDiff(1);
 
-	return outputs;
+	last_timestamp_ = timestamp;
+	return timestamp;
 }
 
-unordered_map<string, Any> SolutionBase::Process(string_view input_stream, Any input) {
+unordered_map<string, Any> SolutionBase::Process(string_view input_stream, Any input, Deadline deadline) {
 	unordered_map<string_view, Any> inputs;
 	
 	inputs.emplace(input_stream, move(input));
-	return Process(move(inputs));
+	return Process(move(inputs), deadline);
 }
 
 }
@@ -15,55 +15,304 @@
 #ifndef MEDIAPIPE_SOLUTIONS_SOLUTION_BASE_H_
 #define MEDIAPIPE_SOLUTIONS_SOLUTION_BASE_H_
 
-#include <any>
+#include <atomic>
 #include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/statusor.h"
 
 #include "any.h"
+#include "calculator_option.h"
+#include "deadline.h"
+#include "result_assembler.h"
+#include "work_stealing_executor.h"
+#include "util/util.h"
 
 // TODO: Document
 
 namespace mediapipe_solutions {
 
+template <typename T>
+class ProcessAwaitable;
+
+// Where a solution's graph runs. By default every graph starts its own
+// executor threads.
+struct ExecutionOptions {
+	// Shared pool to run the graph on instead.
+	std::shared_ptr<WorkStealingExecutor> executor;
+	// Name of the graph in the pool's statistics.
+	std::string name;
+
+	// CPUs for the graph's own threads. Ignored with a shared executor, which
+	// is placed by WorkStealingExecutor::Create.
+	std::vector<int> cpus;
+	// NUMA node for frames from CreateFrame. Also the default for cpus.
+	// Buffers the calculators allocate follow the threads by first touch.
+	int numa_node = -1;
+};
+
 class SolutionBase {
 	public:
 		SolutionBase(
 			mediapipe::CalculatorGraphConfig graph_config,
 			std::unordered_map<std::string, Any> &&side_inputs,
 			std::vector<std::string> outputs,
-			std::unordered_map<std::string, std::any> options = {}
+			std::vector<CalculatorOption> options = {},
+			ExecutionOptions execution = {}
 		);
 
 		SolutionBase(
 			std::string_view graph_config,
 			std::unordered_map<std::string, Any> &&side_inputs,
 			std::vector<std::string> outputs,
-			std::unordered_map<std::string, std::any> options = {}
+			std::vector<CalculatorOption> options = {},
+			ExecutionOptions execution = {}
 		);
 
+		// Closes the graph if Close was not called.
+		~SolutionBase();
+
+		// Waits for the submitted frames and stops the graph. Frames submitted
+		// afterwards are rejected.
 		void Close();
+
+		// Queue-time and run-time statistics of the graph on its shared pool,
+		// if it runs on one.
+		std::optional<GraphExecutorStats> executor_stats() const;
+
+		// Frames dropped for missing their deadline, by stage: "submit" for
+		// frames expired before they were sent, "output" for results that passed
+		// every gate but completed too late, and the node name of every
+		// deadline gate in the graph. Every late frame is counted once.
+		std::map<std::string, uint64_t> deadline_expirations() const;
+
+		// A blank frame for Process, allocated on the graph's NUMA node if one
+		// is set.
+		std::unique_ptr<mediapipe::ImageFrame> CreateFrame(
+			mediapipe::ImageFormat::Format format, int width, int height
+		) const;
 	protected:
-		std::unordered_map<std::string, Any> Process(std::string_view input_stream, Any input);
-		std::unordered_map<std::string, Any> Process(std::unordered_map<std::string_view, Any> &&inputs);
+		using Deadline = std::optional<std::chrono::steady_clock::time_point>;
+		using Callback = std::function<void(absl::StatusOr<std::unordered_map<std::string, Any>> &&)>;
+
+		// Returns once the outputs of the frame are complete. The graph can
+		// still hold the inputs then, so inputs that borrow memory must signal
+		// their release themselves, e.g. through an ImageFrame deleter.
+		//
+		// Throws std::system_error with std::errc::timed_out if the outputs are
+		// not complete by deadline.
+		std::unordered_map<std::string, Any> Process(std::string_view input_stream, Any input, Deadline deadline = std::nullopt);
+		std::unordered_map<std::string, Any> Process(std::unordered_map<std::string_view, Any> &&inputs, Deadline deadline = std::nullopt);
+
+		// Sends inputs at the next timestamp and returns without waiting.
+		// callback receives the outputs of that timestamp on a graph thread, or
+		// DeadlineExceeded once the frame missed deadline. If the graph fails,
+		// every pending callback receives its error.
+		//
+		// A frame that has already expired, or arrives after the graph has
+		// finished, is not sent and callback never runs; the returned status
+		// says why. Callers that submit again from the callback therefore
+		// cannot recurse. Throws if the graph rejects the inputs; callback
+		// then receives the graph's error once it has finished.
+		//
+		// Graphs that declare kDeadlineStream get the deadline of every frame,
+		// so their deadline gates drop late frames between calculators.
+		absl::Status Submit(
+			std::unordered_map<std::string_view, Any> &&inputs,
+			Callback callback,
+			Deadline deadline = std::nullopt
+		);
 	private:
+		template <typename T>
+		friend class ProcessAwaitable;
+
+		std::vector<std::string> outputs_;
+		// Declared before graph_ so that they outlive the graph's tasks and
+		// observer callbacks.
+		std::shared_ptr<WorkStealingExecutor> executor_;
+		std::shared_ptr<GraphExecutor> graph_executor_;
+		int numa_node_ = -1;
+		std::shared_ptr<DeadlineCounters> deadline_counters_;
+		bool deadline_stream_ = false;
+		// Error of the finished graph, for the results Close flushes.
+		absl::Status done_status_;
+		std::unique_ptr<ResultAssembler> results_;
 		mediapipe::CalculatorGraph graph_;
 		std::chrono::steady_clock::time_point start_timestamp_;
-		std::unordered_map<std::string, mediapipe::Packet> graph_outputs_;
+
+		// Serializes submissions, so that timestamps reach the graph and the
+		// assembler in increasing order.
+		std::mutex submit_mutex_;
+		mediapipe::Timestamp last_timestamp_ = mediapipe::Timestamp::Unstarted();
+		// Set once the graph has finished; guarded by submit_mutex_.
+		bool finished_ = false;
+		// Frames whose callback has not run yet.
+		std::atomic<int> pending_ { 0 };
+
+		mediapipe::Timestamp NextTimestamp();
+
+		// The graph only reports errors through HasError and WaitUntilDone, so
+		// the callbacks of pending frames would wait forever for a failed graph.
+		// A single thread polls the graphs of all solutions that have frames in
+		// flight and finishes those that failed. It sleeps while no frame is
+		// pending anywhere.
+		static void WatchForErrors();
+		void Watch();
+		// Returns once the watch no longer touches this solution.
+		void Unwatch();
+		// Records how the graph finished and settles every pending frame.
+		void Finish(absl::Status status);
 
 		void Init(
 			mediapipe::CalculatorGraphConfig graph_config,
 			std::unordered_map<std::string, Any> side_inputs,
 			std::vector<std::string> outputs,
-			std::unordered_map<std::string, std::any> options
+			std::vector<CalculatorOption> options,
+			ExecutionOptions execution
+		);
+};
+
+#if defined(__cpp_impl_coroutine)
+// Result of a solution's ProcessAsync, for use with co_await. The inputs are
+// submitted when the awaiting coroutine suspends. Once the outputs arrive, or
+// the graph fails, the coroutine is resumed on executor, or directly on the
+// graph thread that produced them if executor is null. transform converts the
+// outputs on the resuming thread.
+//
+// Resuming on the graph thread saves a handoff, but the coroutine then runs as
+// part of a graph task. It must not submit to the same solution from there:
+// once the graph throttles its inputs, the submission waits for graph threads
+// while holding one, and can deadlock. Coroutines that submit the next frame
+// right away need an executor.
+template <typename T>
+class ProcessAwaitable {
+	public:
+		using Transform = std::function<T(std::unordered_map<std::string, Any> &&)>;
+
+		ProcessAwaitable(
+			SolutionBase &solution,
+			std::unordered_map<std::string_view, Any> &&inputs,
+			mediapipe::Executor *executor,
+			Transform transform,
+			SolutionBase::Deadline deadline = std::nullopt
 		);
+
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<> handle);
+		T await_resume();
+	private:
+		// Shared with the output callback, which may outlive the awaitable if
+		// submitting fails halfway. Whoever sets completed first stores the result
+		// and resumes.
+		struct State {
+			std::atomic<bool> completed { false };
+			std::unordered_map<std::string, Any> outputs;
+			std::exception_ptr error;
+		};
+
+		SolutionBase &solution_;
+		std::unordered_map<std::string_view, Any> inputs_;
+		mediapipe::Executor *executor_;
+		Transform transform_;
+		SolutionBase::Deadline deadline_;
+		std::shared_ptr<State> state_;
 };
 
+template <typename T>
+ProcessAwaitable<T>::ProcessAwaitable(
+	SolutionBase &solution,
+	std::unordered_map<std::string_view, Any> &&inputs,
+	mediapipe::Executor *executor,
+	Transform transform,
+	SolutionBase::Deadline deadline
+) :
+	solution_(solution),
+	inputs_(std::move(inputs)),
+	executor_(executor),
+	transform_(std::move(transform)),
+	deadline_(deadline),
+	state_(std::make_shared<State>()) {
+}
+
+template <typename T>
+bool ProcessAwaitable<T>::await_ready() const noexcept {
+	return false;
+}
+
+template <typename T>
+bool ProcessAwaitable<T>::await_suspend(std::coroutine_handle<> handle) {
+	// The awaitable may be gone as soon as the callback resumes the coroutine.
+	auto state = state_;
+
+	try {
+		const auto status = solution_.Submit(
+			std::move(inputs_),
+			[state, handle, executor = executor_](absl::StatusOr<std::unordered_map<std::string, Any>> &&outputs) {
+				if (state->completed.exchange(true, std::memory_order_acq_rel))
+					return;
+
+				if (outputs.ok()) {
+					state->outputs = std::move(*outputs);
+				}
+				else {
+					try {
+						ThrowError(outputs.status());
+					}
+					catch (...) {
+						state->error = std::current_exception();
+					}
+				}
+
+				if (executor)
+					executor->Schedule([handle]() { handle.resume(); });
+				else
+					handle.resume();
+			},
+			deadline_
+		);
+
+		// Not submitted, so nothing else resumes the coroutine.
+		if (!status.ok())
+			ThrowError(status);
+	}
+	catch (...) {
+		auto error = std::current_exception();
+
+		if (state->completed.exchange(true, std::memory_order_acq_rel))
+			return true;
+
+		state->error = error;
+		return false;
+	}
+
+	return true;
+}
+
+template <typename T>
+T ProcessAwaitable<T>::await_resume() {
+	if (state_->error)
+		std::rethrow_exception(state_->error);
+
+	return transform_(std::move(state_->outputs));
+}
+#endif	// defined(__cpp_impl_coroutine)
+
 }	// namespace mediapipe_solutions
 
 #endif	// MEDIAPIPE_SOLUTIONS_SOLUTION_BASE_H_
@@ -0,0 +1,196 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/solution_base.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+constexpr auto kSettleTimeout = seconds(10);
+
+// Passes int packets through and fails the graph on a negative one.
+class FailOnNegativeCalculator : public CalculatorBase {
+	public:
+		static absl::Status GetContract(CalculatorContract *cc) {
+			cc->Inputs().Index(0).Set<int>();
+			cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+			return absl::OkStatus();
+		}
+
+		absl::Status Process(CalculatorContext *cc) override {
+			if (cc->Inputs().Index(0).Get<int>() < 0)
+				return absl::InternalError("Negative input.");
+
+			cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+			return absl::OkStatus();
+		}
+};
+REGISTER_CALCULATOR(FailOnNegativeCalculator);
+
+class TestSolution : public SolutionBase {
+	public:
+		explicit TestSolution(ExecutionOptions execution = {}) :
+			SolutionBase(
+				R"pb(
+					input_stream: "input"
+					output_stream: "output"
+					node { calculator: "FailOnNegativeCalculator" input_stream: "input" output_stream: "output" }
+				)pb",
+				{},
+				{ "output" },
+				{},
+				move(execution)
+			) {
+		}
+
+		using SolutionBase::Process;
+
+		// Resolves to the callback's result, or to the status Submit returned
+		// if it did not send the frame.
+		future<absl::Status> Submit(int value) {
+			auto result = make_shared<promise<absl::Status>>();
+			auto future = result->get_future();
+
+			const auto status = SolutionBase::Submit(
+				Inputs(value),
+				[result](absl::StatusOr<unordered_map<string, Any>> &&outputs) { result->set_value(outputs.status()); }
+			);
+
+			if (!status.ok())
+				result->set_value(status);
+
+			return future;
+		}
+
+		static unordered_map<string_view, Any> Inputs(int value) {
+			unordered_map<string_view, Any> inputs;
+
+			inputs.emplace("input", value);
+			return inputs;
+		}
+};
+
+TEST(SolutionBaseTest, ProcessReturnsTheOutputs) {
+	TestSolution solution;
+
+	const auto outputs = solution.Process("input", 7);
+
+	ASSERT_EQ(outputs.count("output"), 1u);
+	EXPECT_EQ(outputs.at("output").Get<int>(), 7);
+}
+
+TEST(SolutionBaseTest, DestructionSettlesPendingCallbacks) {
+	vector<future<absl::Status>> results;
+
+	{
+		auto executor = WorkStealingExecutor::Create(2);
+		ExecutionOptions execution;
+
+		execution.executor = executor;
+
+		TestSolution solution(move(execution));
+
+		for (int i = 0; i < 8; ++i)
+			results.push_back(solution.Submit(i));
+	}
+
+	for (auto &result : results) {
+		ASSERT_EQ(result.wait_for(seconds(0)), future_status::ready);
+		EXPECT_TRUE(result.get().ok());
+	}
+}
+
+TEST(SolutionBaseTest, GraphErrorSettlesPendingCallbacks) {
+	TestSolution solution;
+	vector<future<absl::Status>> results;
+
+	results.push_back(solution.Submit(-1));
+
+	// Submitted while or after the graph fails; either way they settle.
+	for (int i = 0; i < 8; ++i)
+		results.push_back(solution.Submit(i));
+
+	for (auto &result : results) {
+		ASSERT_EQ(result.wait_for(kSettleTimeout), future_status::ready);
+		EXPECT_FALSE(result.get().ok());
+	}
+
+	EXPECT_FALSE(solution.Submit(1).get().ok());
+}
+
+TEST(SolutionBaseTest, ProcessThrowsTheGraphError) {
+	TestSolution solution;
+
+	EXPECT_THROW(solution.Process("input", -1), exception);
+}
+
+#if defined(__cpp_impl_coroutine)
+// Coroutine that starts right away and frees itself when done.
+struct DetachedTask {
+	struct promise_type {
+		DetachedTask get_return_object() { return {}; }
+		suspend_never initial_suspend() noexcept { return {}; }
+		suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { terminate(); }
+	};
+};
+
+DetachedTask AwaitProcess(TestSolution &solution, int value, promise<string> &error) {
+	try {
+		co_await ProcessAwaitable<int>(
+			solution, TestSolution::Inputs(value), nullptr,
+			[](unordered_map<string, Any> &&outputs) { return outputs.at("output").Get<int>(); }
+		);
+		error.set_value("");
+	}
+	catch (const exception &e) {
+		error.set_value(e.what());
+	}
+}
+
+TEST(SolutionBaseTest, GraphErrorResumesProcessAwaitables) {
+	TestSolution solution;
+	promise<string> failed, next;
+
+	AwaitProcess(solution, -1, failed);
+	AwaitProcess(solution, 1, next);
+
+	auto failedError = failed.get_future();
+	auto nextError = next.get_future();
+
+	ASSERT_EQ(failedError.wait_for(kSettleTimeout), future_status::ready);
+	ASSERT_EQ(nextError.wait_for(kSettleTimeout), future_status::ready);
+	EXPECT_NE(failedError.get(), "");
+	// Either resumed with the graph's error or rejected by Submit.
+	EXPECT_NE(nextError.get(), "");
+}
+#endif	// defined(__cpp_impl_coroutine)
+
+}	// namespace
+}	// namespace mediapipe_solutions
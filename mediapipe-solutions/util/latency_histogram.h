@@ -0,0 +1,120 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_UTIL_LATENCY_HISTOGRAM_H_
+#define MEDIAPIPE_SOLUTIONS_UTIL_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mediapipe_solutions {
+
+// Log-linear histogram of durations in microseconds. Every power of two is
+// split into eight buckets, so percentiles are accurate to within 12.5%.
+// Recording is wait-free and may happen from any thread.
+class LatencyHistogram {
+	public:
+		void Record(std::chrono::microseconds value);
+
+		uint64_t count() const;
+		std::chrono::microseconds mean() const;
+		std::chrono::microseconds max() const;
+		std::chrono::microseconds Percentile(double percentile) const;
+	private:
+		static constexpr int kLinearBuckets = 16;
+		static constexpr int kSubBuckets = 8;
+		static constexpr int kBucketCount = kLinearBuckets + (64 - 4) * kSubBuckets;
+
+		std::array<std::atomic<uint64_t>, kBucketCount> buckets_ {};
+		std::atomic<uint64_t> count_ { 0 };
+		std::atomic<uint64_t> sum_ { 0 };
+		std::atomic<uint64_t> max_ { 0 };
+
+		static int BucketOf(uint64_t value);
+		static uint64_t LowerBoundOf(int bucket);
+};
+
+inline void LatencyHistogram::Record(std::chrono::microseconds value) {
+	const uint64_t micros = value.count() > 0 ? uint64_t(value.count()) : 0;
+
+	buckets_[BucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+	sum_.fetch_add(micros, std::memory_order_relaxed);
+
+	uint64_t previous = max_.load(std::memory_order_relaxed);
+
+	while (previous < micros and !max_.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+	}
+}
+
+inline uint64_t LatencyHistogram::count() const {
+	return count_.load(std::memory_order_relaxed);
+}
+
+inline std::chrono::microseconds LatencyHistogram::mean() const {
+	const auto samples = count();
+
+	return std::chrono::microseconds(samples ? sum_.load(std::memory_order_relaxed) / samples : 0);
+}
+
+inline std::chrono::microseconds LatencyHistogram::max() const {
+	return std::chrono::microseconds(max_.load(std::memory_order_relaxed));
+}
+
+inline std::chrono::microseconds LatencyHistogram::Percentile(double percentile) const {
+	const auto samples = count();
+
+	if (samples == 0)
+		return std::chrono::microseconds(0);
+
+	const auto rank = uint64_t(percentile / 100.0 * double(samples - 1)) + 1;
+	uint64_t seen = 0;
+
+	for (int bucket = 0; bucket < kBucketCount; ++bucket) {
+		seen += buckets_[bucket].load(std::memory_order_relaxed);
+
+		if (seen >= rank)
+			return std::chrono::microseconds(LowerBoundOf(bucket));
+	}
+
+	return max();
+}
+
+inline int LatencyHistogram::BucketOf(uint64_t value) {
+	if (value < kLinearBuckets)
+		return int(value);
+
+	int msb = 63;
+
+	while (!(value >> msb))
+		--msb;
+
+	return kLinearBuckets + (msb - 4) * kSubBuckets + int((value >> (msb - 3)) & (kSubBuckets - 1));
+}
+
+inline uint64_t LatencyHistogram::LowerBoundOf(int bucket) {
+	if (bucket < kLinearBuckets)
+		return uint64_t(bucket);
+
+	const int msb = (bucket - kLinearBuckets) / kSubBuckets + 4;
+	const int sub = (bucket - kLinearBuckets) % kSubBuckets;
+
+	return uint64_t(kSubBuckets + sub) << (msb - 3);
+}
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_UTIL_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,101 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/util/latency_histogram.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace mediapipe_solutions {
+namespace {
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero) {
+	LatencyHistogram histogram;
+
+	EXPECT_EQ(histogram.count(), 0u);
+	EXPECT_EQ(histogram.mean(), microseconds(0));
+	EXPECT_EQ(histogram.max(), microseconds(0));
+	EXPECT_EQ(histogram.Percentile(50), microseconds(0));
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+	LatencyHistogram histogram;
+
+	for (int i = 0; i < 16; ++i)
+		histogram.Record(microseconds(i));
+
+	EXPECT_EQ(histogram.count(), 16u);
+	EXPECT_EQ(histogram.mean(), microseconds(7));
+	EXPECT_EQ(histogram.max(), microseconds(15));
+	EXPECT_EQ(histogram.Percentile(0), microseconds(0));
+	EXPECT_EQ(histogram.Percentile(50), microseconds(7));
+	EXPECT_EQ(histogram.Percentile(100), microseconds(15));
+}
+
+TEST(LatencyHistogramTest, PercentilesAreWithinBucketPrecision) {
+	LatencyHistogram histogram;
+
+	for (int i = 0; i < 99; ++i)
+		histogram.Record(microseconds(1000));
+
+	histogram.Record(microseconds(100000));
+
+	// Percentiles report the lower bound of their bucket.
+	EXPECT_LE(histogram.Percentile(50), microseconds(1000));
+	EXPECT_GE(histogram.Percentile(50), microseconds(875));
+	EXPECT_LE(histogram.Percentile(99), microseconds(1000));
+	EXPECT_LE(histogram.Percentile(100), microseconds(100000));
+	EXPECT_GE(histogram.Percentile(100), microseconds(87500));
+	EXPECT_EQ(histogram.max(), microseconds(100000));
+	EXPECT_EQ(histogram.mean(), microseconds((99 * 1000 + 100000) / 100));
+}
+
+TEST(LatencyHistogramTest, NegativeDurationsCountAsZero) {
+	LatencyHistogram histogram;
+
+	histogram.Record(microseconds(-5));
+
+	EXPECT_EQ(histogram.count(), 1u);
+	EXPECT_EQ(histogram.max(), microseconds(0));
+	EXPECT_EQ(histogram.Percentile(100), microseconds(0));
+}
+
+TEST(LatencyHistogramTest, RecordsFromManyThreads) {
+	constexpr int kThreads = 4;
+	constexpr int kSamples = 10000;
+	LatencyHistogram histogram;
+	vector<thread> threads;
+
+	for (int i = 0; i < kThreads; ++i) {
+		threads.emplace_back([&histogram, i]() {
+			for (int sample = 0; sample < kSamples; ++sample)
+				histogram.Record(microseconds(i + 1));
+		});
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	EXPECT_EQ(histogram.count(), uint64_t(kThreads * kSamples));
+	EXPECT_EQ(histogram.max(), microseconds(kThreads));
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
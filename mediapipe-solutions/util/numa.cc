@@ -0,0 +1,143 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/util/numa.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+using namespace std;
+using namespace mediapipe;
+
+namespace {
+	// From <numaif.h>, which would need libnuma.
+	constexpr int kMpolBind = 2;
+	constexpr unsigned kMpolMfStrict = 1 << 0;
+
+	constexpr int kMaxNumaNodes = 1024;
+	constexpr int kWidthStepAlignment = 16;
+
+	// Parses sysfs lists such as "0-3,8-11".
+	vector<int> ParseCpuList(const string &list) {
+		vector<int> cpus;
+		stringstream ranges(list);
+		string range;
+
+		while (getline(ranges, range, ',')) {
+			if (range.empty() or range == "\n")
+				continue;
+
+			const auto dash = range.find('-');
+			const int first = stoi(range.substr(0, dash));
+			const int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+
+			for (int cpu = first; cpu <= last; ++cpu)
+				cpus.push_back(cpu);
+		}
+
+		return cpus;
+	}
+}
+
+namespace mediapipe_solutions {
+
+int NumaNodeCount() {
+	ifstream online("/sys/devices/system/node/online");
+	string list;
+
+	if (!getline(online, list))
+		return 1;
+
+	const auto nodes = ParseCpuList(list);
+
+	return nodes.empty() ? 1 : nodes.back() + 1;
+}
+
+vector<int> CpusOfNumaNode(int node) {
+	ifstream cpulist("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+	string list;
+
+	if (node < 0 or !getline(cpulist, list))
+		return {};
+
+	return ParseCpuList(list);
+}
+
+void PinThread(pthread_t thread, const vector<int> &cpus) {
+	cpu_set_t set;
+
+	if (cpus.empty())
+		throw invalid_argument("No CPUs to pin the thread to.");
+
+	CPU_ZERO(&set);
+
+	// CPU_SET does not check its argument.
+	for (const int cpu : cpus) {
+		if (cpu < 0 or cpu >= CPU_SETSIZE)
+			throw invalid_argument("Invalid CPU " + to_string(cpu) + ".");
+
+		CPU_SET(cpu, &set);
+	}
+
+	if (const int error = pthread_setaffinity_np(thread, sizeof(set), &set))
+		throw system_error(error, system_category(), "Failed to pin thread");
+}
+
+unique_ptr<ImageFrame> CreateImageFrameOnNumaNode(ImageFormat::Format format, int width, int height, int node) {
+	if (node < 0 or node >= kMaxNumaNodes)
+		throw invalid_argument("Invalid NUMA node " + to_string(node) + ".");
+
+	const int rowBytes = width * ImageFrame::NumberOfChannelsForFormat(format) * ImageFrame::ByteDepthForFormat(format);
+	const int widthStep = (rowBytes + kWidthStepAlignment - 1) / kWidthStepAlignment * kWidthStepAlignment;
+	const size_t size = max(size_t(widthStep) * height, size_t(1));
+
+	void *pixels = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (pixels == MAP_FAILED)
+		throw system_error(errno, system_category(), "Failed to map frame buffer");
+
+	unsigned long nodeMask[kMaxNumaNodes / (sizeof(unsigned long) * CHAR_BIT)] = {};
+
+	nodeMask[node / (sizeof(unsigned long) * CHAR_BIT)] |= 1UL << (node % (sizeof(unsigned long) * CHAR_BIT));
+
+	// The kernel reads maxnode - 1 bits of the mask.
+	if (syscall(SYS_mbind, pixels, size, kMpolBind, nodeMask, kMaxNumaNodes + 1, kMpolMfStrict) != 0) {
+		const int error = errno;
+
+		munmap(pixels, size);
+		throw system_error(error, system_category(), "Failed to bind frame buffer to NUMA node " + to_string(node));
+	}
+
+	// Faults every page in on the bound node now rather than during inference.
+	memset(pixels, 0, size);
+
+	return make_unique<ImageFrame>(
+		format, width, height, widthStep, static_cast<uint8 *>(pixels),
+		[size](uint8 *data) { munmap(data, size); }
+	);
+}
+
+}	// namespace mediapipe_solutions
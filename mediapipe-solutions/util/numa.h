@@ -0,0 +1,47 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_UTIL_NUMA_H_
+#define MEDIAPIPE_SOLUTIONS_UTIL_NUMA_H_
+
+#include <pthread.h>
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+namespace mediapipe_solutions {
+
+// Number of NUMA nodes, 1 where the system reports none.
+int NumaNodeCount();
+
+// CPUs of a NUMA node as listed in sysfs; empty if the node does not exist.
+std::vector<int> CpusOfNumaNode(int node);
+
+// Restricts a thread to cpus. Throws std::invalid_argument if cpus is empty
+// or lists a CPU outside [0, CPU_SETSIZE), and std::system_error if the
+// kernel refuses the rest, e.g. CPUs that are offline.
+void PinThread(pthread_t thread, const std::vector<int> &cpus);
+
+// An ImageFrame whose pixels are bound to the memory of a NUMA node. The
+// pixels are zeroed, so every page is in place before the frame is used.
+// Throws std::system_error if the kernel refuses the binding.
+std::unique_ptr<mediapipe::ImageFrame> CreateImageFrameOnNumaNode(
+	mediapipe::ImageFormat::Format format, int width, int height, int node
+);
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_UTIL_NUMA_H_
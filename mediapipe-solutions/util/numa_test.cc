@@ -0,0 +1,126 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/util/numa.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace mediapipe;
+
+namespace mediapipe_solutions {
+namespace {
+
+vector<int> Affinity(pthread_t thread) {
+	cpu_set_t set;
+	vector<int> cpus;
+
+	CPU_ZERO(&set);
+	EXPECT_EQ(pthread_getaffinity_np(thread, sizeof(set), &set), 0);
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+		if (CPU_ISSET(cpu, &set))
+			cpus.push_back(cpu);
+	}
+
+	return cpus;
+}
+
+// A thread that waits until the test lets it finish.
+class IdleThread {
+	public:
+		IdleThread() : thread_([this]() {
+			unique_lock<mutex> lock(mutex_);
+			wake_.wait(lock, [this]() { return done_; });
+		}) {
+		}
+
+		~IdleThread() {
+			{
+				lock_guard<mutex> lock(mutex_);
+				done_ = true;
+			}
+
+			wake_.notify_one();
+			thread_.join();
+		}
+
+		pthread_t handle() {
+			return thread_.native_handle();
+		}
+	private:
+		mutex mutex_;
+		condition_variable wake_;
+		bool done_ = false;
+		thread thread_;
+};
+
+TEST(NumaTest, PinThreadRejectsCpusOutsideTheSet) {
+	IdleThread thread;
+	const auto before = Affinity(thread.handle());
+
+	EXPECT_THROW(PinThread(thread.handle(), {}), invalid_argument);
+	EXPECT_THROW(PinThread(thread.handle(), { -1 }), invalid_argument);
+	EXPECT_THROW(PinThread(thread.handle(), { CPU_SETSIZE }), invalid_argument);
+	EXPECT_THROW(PinThread(thread.handle(), { before.front(), 1 << 20 }), invalid_argument);
+
+	// Nothing is applied when one CPU is invalid.
+	EXPECT_EQ(Affinity(thread.handle()), before);
+}
+
+TEST(NumaTest, PinThreadRestrictsTheThread) {
+	IdleThread thread;
+	const auto allowed = Affinity(thread.handle());
+
+	ASSERT_FALSE(allowed.empty());
+
+	PinThread(thread.handle(), { allowed.back() });
+	EXPECT_EQ(Affinity(thread.handle()), vector<int> { allowed.back() });
+
+	PinThread(thread.handle(), allowed);
+	EXPECT_EQ(Affinity(thread.handle()), allowed);
+}
+
+TEST(NumaTest, NodesListValidCpus) {
+	const int nodes = NumaNodeCount();
+
+	ASSERT_GE(nodes, 1);
+
+	for (int node = 0; node < nodes; ++node) {
+		for (const int cpu : CpusOfNumaNode(node)) {
+			EXPECT_GE(cpu, 0);
+			EXPECT_LT(cpu, CPU_SETSIZE);
+		}
+	}
+
+	EXPECT_TRUE(CpusOfNumaNode(-1).empty());
+	EXPECT_TRUE(CpusOfNumaNode(nodes + 1000).empty());
+}
+
+TEST(NumaTest, CreateImageFrameRejectsInvalidNodes) {
+	EXPECT_THROW(CreateImageFrameOnNumaNode(ImageFormat::SRGB, 4, 4, -1), invalid_argument);
+	EXPECT_THROW(CreateImageFrameOnNumaNode(ImageFormat::SRGB, 4, 4, 1 << 20), invalid_argument);
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions
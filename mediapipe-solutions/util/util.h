@@ -16,9 +16,11 @@
 #define MEDIAPIPE_SOLUTIONS_UTIL_UTIL_H_
 
 #include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
+#include "mediapipe/framework/validated_graph_config.h"
 
 namespace mediapipe_solutions {
 
@@ -36,6 +38,8 @@ inline void ThrowError(const ::absl::Status& status)
       throw std::logic_error(std::string(status.message()));
     case absl::StatusCode::kInternal:
       throw std::logic_error(std::string(status.message()));
+    case absl::StatusCode::kDeadlineExceeded:
+      throw std::system_error(make_error_code(std::errc::timed_out), std::string(status.message()));
     default:
       throw std::runtime_error(std::string(status.message()));
   }
@@ -87,6 +91,26 @@ inline ::mediapipe::CalculatorGraphConfig ReadCalculatorGraphConfigFromFile(
   return graph_config_proto;
 }
 
+// Expands all subgraphs of a CalculatorGraphConfig and validates the result.
+inline ::mediapipe::CalculatorGraphConfig ExpandGraphConfig(
+    const ::mediapipe::CalculatorGraphConfig& graph_config) {
+  ::mediapipe::ValidatedGraphConfig validated_graph_config;
+  ThrowIfNotOk(validated_graph_config.Initialize(graph_config));
+  return validated_graph_config.Config();
+}
+
+// Returns true if every node is a registered calculator, i.e. the config has
+// no subgraphs left to expand.
+inline bool IsGraphConfigExpanded(
+    const ::mediapipe::CalculatorGraphConfig& graph_config) {
+  for (const auto& node : graph_config.node()) {
+    if (!::mediapipe::CalculatorBaseRegistry::IsRegistered(node.calculator())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace mediapipe_solutions
 
 #endif  // MEDIAPIPE_SOLUTIONS_UTIL_UTIL_H_
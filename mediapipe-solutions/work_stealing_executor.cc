@@ -0,0 +1,265 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/work_stealing_executor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mediapipe-solutions/util/numa.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace mediapipe_solutions {
+
+GraphExecutor::GraphExecutor(WorkStealingExecutor &pool, string name) :
+	pool_(pool),
+	name_(move(name)) {
+}
+
+void GraphExecutor::Schedule(function<void()> task) {
+	pool_.Enqueue(*this, move(task));
+}
+
+GraphExecutorStats GraphExecutor::Stats() const {
+	GraphExecutorStats stats;
+
+	stats.name = name_;
+	stats.tasks = queue_time_.count();
+	stats.queued = queued_.load(memory_order_relaxed);
+	stats.queue_time_mean = queue_time_.mean();
+	stats.queue_time_p50 = queue_time_.Percentile(50);
+	stats.queue_time_p99 = queue_time_.Percentile(99);
+	stats.queue_time_max = queue_time_.max();
+	stats.run_time = microseconds(run_time_.load(memory_order_relaxed));
+	return stats;
+}
+
+shared_ptr<WorkStealingExecutor> WorkStealingExecutor::Create(int num_threads, int quantum, vector<int> cpus) {
+	shared_ptr<WorkStealingExecutor> executor(new WorkStealingExecutor(max(quantum, 1)));
+
+	if (num_threads <= 0)
+		num_threads = !cpus.empty() ? int(cpus.size()) : max(int(thread::hardware_concurrency()), 1);
+
+	executor->Start(num_threads, cpus);
+	return executor;
+}
+
+WorkStealingExecutor::WorkStealingExecutor(int quantum) :
+	quantum_(quantum) {
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+	{
+		lock_guard<mutex> lock(mutex_);
+		stopping_ = true;
+	}
+
+	wake_.notify_all();
+
+	for (auto &worker : workers_) {
+		if (worker->thread.joinable())
+			worker->thread.join();
+	}
+}
+
+void WorkStealingExecutor::Start(int num_threads, const vector<int> &cpus) {
+	for (int i = 0; i < num_threads; ++i)
+		workers_.push_back(make_unique<Worker>());
+
+	// Workers steal from each other, so all of them exist before any starts.
+	for (int i = 0; i < num_threads; ++i) {
+		workers_[i]->thread = thread(&WorkStealingExecutor::RunWorker, this, i);
+
+		// Pinned to the whole set rather than one CPU each, so the kernel can
+		// still balance the workers within it.
+		if (!cpus.empty())
+			PinThread(workers_[i]->thread.native_handle(), cpus);
+	}
+}
+
+shared_ptr<GraphExecutor> WorkStealingExecutor::CreateGraphExecutor(string name) {
+	shared_ptr<GraphExecutor> graph(new GraphExecutor(*this, move(name)));
+	lock_guard<mutex> lock(mutex_);
+
+	graphs_.erase(
+		remove_if(graphs_.begin(), graphs_.end(), [](const auto &graph) { return graph.expired(); }),
+		graphs_.end()
+	);
+	graphs_.push_back(graph);
+	return graph;
+}
+
+int WorkStealingExecutor::num_threads() const {
+	return int(workers_.size());
+}
+
+vector<GraphExecutorStats> WorkStealingExecutor::Stats() const {
+	vector<GraphExecutorStats> stats;
+	lock_guard<mutex> lock(mutex_);
+
+	for (const auto &graph : graphs_) {
+		if (auto alive = graph.lock())
+			stats.push_back(alive->Stats());
+	}
+
+	return stats;
+}
+
+void WorkStealingExecutor::Enqueue(GraphExecutor &graph, function<void()> task) {
+	bool becameReady;
+
+	queued_.fetch_add(1, memory_order_relaxed);
+	graph.queued_.fetch_add(1, memory_order_relaxed);
+
+	{
+		lock_guard<mutex> lock(graph.mutex_);
+
+		graph.tasks_.push_back({ move(task), steady_clock::now() });
+		becameReady = !exchange(graph.ready_, true);
+	}
+
+	{
+		lock_guard<mutex> lock(mutex_);
+
+		if (becameReady)
+			ready_.push_back(graph.shared_from_this());
+	}
+
+	wake_.notify_one();
+}
+
+void WorkStealingExecutor::RunWorker(int index) {
+	auto &worker = *workers_[index];
+	Task task;
+
+	while (true) {
+		if (PopLocal(worker, task) or TakeFromGraphs(worker, task) or Steal(index, task)) {
+			Run(task);
+			continue;
+		}
+
+		unique_lock<mutex> lock(mutex_);
+
+		wake_.wait(lock, [this]() { return stopping_ or queued_.load(memory_order_relaxed) > 0; });
+
+		if (stopping_ and queued_.load(memory_order_relaxed) == 0)
+			return;
+
+		// A task may be counted before it can be taken; let its scheduler
+		// finish publishing it.
+		lock.unlock();
+		this_thread::yield();
+	}
+}
+
+bool WorkStealingExecutor::PopLocal(Worker &worker, Task &task) {
+	lock_guard<mutex> lock(worker.mutex);
+
+	if (worker.tasks.empty())
+		return false;
+
+	task = move(worker.tasks.front());
+	worker.tasks.pop_front();
+	return true;
+}
+
+bool WorkStealingExecutor::TakeFromGraphs(Worker &worker, Task &task) {
+	shared_ptr<GraphExecutor> graph;
+
+	{
+		lock_guard<mutex> lock(mutex_);
+
+		if (ready_.empty())
+			return false;
+
+		graph = move(ready_.front());
+		ready_.pop_front();
+	}
+
+	vector<GraphExecutor::Task> taken;
+	bool stillReady;
+
+	{
+		lock_guard<mutex> lock(graph->mutex_);
+		const auto count = min(graph->tasks_.size(), size_t(quantum_));
+
+		for (size_t i = 0; i < count; ++i) {
+			taken.push_back(move(graph->tasks_.front()));
+			graph->tasks_.pop_front();
+		}
+
+		stillReady = graph->ready_ = !graph->tasks_.empty();
+	}
+
+	// Back to the end of the line, behind every other graph with work.
+	if (stillReady) {
+		lock_guard<mutex> lock(mutex_);
+		ready_.push_back(graph);
+	}
+
+	if (taken.empty())
+		return false;
+
+	task = { graph, move(taken.front()) };
+
+	if (taken.size() > 1) {
+		{
+			lock_guard<mutex> lock(worker.mutex);
+
+			for (size_t i = 1; i < taken.size(); ++i)
+				worker.tasks.push_back({ graph, move(taken[i]) });
+		}
+
+		wake_.notify_one();
+	}
+
+	return true;
+}
+
+bool WorkStealingExecutor::Steal(int index, Task &task) {
+	for (size_t offset = 1; offset < workers_.size(); ++offset) {
+		auto &victim = *workers_[(index + offset) % workers_.size()];
+		lock_guard<mutex> lock(victim.mutex);
+
+		// The victim works from the front; take from the back.
+		if (!victim.tasks.empty()) {
+			task = move(victim.tasks.back());
+			victim.tasks.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingExecutor::Run(Task &task) {
+	const auto start = steady_clock::now();
+	auto &graph = *task.graph;
+
+	queued_.fetch_sub(1, memory_order_relaxed);
+	graph.queued_.fetch_sub(1, memory_order_relaxed);
+	graph.queue_time_.Record(duration_cast<microseconds>(start - task.task.scheduled));
+
+	task.task.function();
+
+	graph.run_time_.fetch_add(
+		duration_cast<microseconds>(steady_clock::now() - start).count(), memory_order_relaxed);
+
+	// Releases the graph executor, which may be its last reference.
+	task = Task();
+}
+
+}	// namespace mediapipe_solutions
@@ -0,0 +1,149 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_SOLUTIONS_WORK_STEALING_EXECUTOR_H_
+#define MEDIAPIPE_SOLUTIONS_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mediapipe/framework/executor.h"
+
+#include "util/latency_histogram.h"
+
+namespace mediapipe_solutions {
+
+class WorkStealingExecutor;
+
+struct GraphExecutorStats {
+	std::string name;
+	uint64_t tasks;
+	// Tasks scheduled but not started yet.
+	uint64_t queued;
+	// Time from Schedule until a worker starts the task.
+	std::chrono::microseconds queue_time_mean;
+	std::chrono::microseconds queue_time_p50;
+	std::chrono::microseconds queue_time_p99;
+	std::chrono::microseconds queue_time_max;
+	// Total time spent running the graph's tasks.
+	std::chrono::microseconds run_time;
+};
+
+// The executor one graph sees. Its tasks run on the shared pool.
+class GraphExecutor : public mediapipe::Executor, public std::enable_shared_from_this<GraphExecutor> {
+	public:
+		void Schedule(std::function<void()> task) override;
+
+		GraphExecutorStats Stats() const;
+	private:
+		friend class WorkStealingExecutor;
+
+		struct Task {
+			std::function<void()> function;
+			std::chrono::steady_clock::time_point scheduled;
+		};
+
+		WorkStealingExecutor &pool_;
+		const std::string name_;
+
+		mutable std::mutex mutex_;
+		std::deque<Task> tasks_;
+		// Whether the graph is in the pool's ready list or being served.
+		bool ready_ = false;
+
+		LatencyHistogram queue_time_;
+		std::atomic<uint64_t> queued_ { 0 };
+		std::atomic<uint64_t> run_time_ { 0 };
+
+		GraphExecutor(WorkStealingExecutor &pool, std::string name);
+};
+
+// A thread pool shared by many graphs, so that they do not each start their
+// own threads.
+//
+// Each graph gets its own FIFO queue through CreateGraphExecutor. Workers
+// serve graphs with pending tasks round-robin, taking at most quantum tasks
+// from one graph per turn, so a busy graph cannot starve the others. The
+// tasks of a turn go to the worker's own deque, from which idle workers
+// steal.
+//
+// The pool must outlive the graphs running on it; SolutionBase keeps a
+// reference for as long as its graph exists.
+class WorkStealingExecutor {
+	public:
+		// num_threads = 0 uses one thread per hardware thread, or per CPU in
+		// cpus. With cpus, the worker threads only run on those CPUs.
+		static std::shared_ptr<WorkStealingExecutor> Create(
+			int num_threads = 0, int quantum = 4, std::vector<int> cpus = {}
+		);
+
+		WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+		WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+		~WorkStealingExecutor();
+
+		std::shared_ptr<GraphExecutor> CreateGraphExecutor(std::string name);
+
+		int num_threads() const;
+
+		// Statistics of every graph executor still alive.
+		std::vector<GraphExecutorStats> Stats() const;
+	private:
+		friend class GraphExecutor;
+
+		struct Task {
+			std::shared_ptr<GraphExecutor> graph;
+			GraphExecutor::Task task;
+		};
+
+		struct Worker {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+			std::thread thread;
+		};
+
+		const int quantum_;
+		std::vector<std::unique_ptr<Worker>> workers_;
+
+		mutable std::mutex mutex_;
+		std::condition_variable wake_;
+		std::deque<std::shared_ptr<GraphExecutor>> ready_;
+		std::vector<std::weak_ptr<GraphExecutor>> graphs_;
+		bool stopping_ = false;
+
+		// Tasks scheduled and not yet started, wherever they wait.
+		std::atomic<uint64_t> queued_ { 0 };
+
+		WorkStealingExecutor(int quantum);
+
+		void Start(int num_threads, const std::vector<int> &cpus);
+		void Enqueue(GraphExecutor &graph, std::function<void()> task);
+		void RunWorker(int index);
+		bool PopLocal(Worker &worker, Task &task);
+		bool TakeFromGraphs(Worker &worker, Task &task);
+		bool Steal(int index, Task &task);
+		void Run(Task &task);
+};
+
+}	// namespace mediapipe_solutions
+
+#endif	// MEDIAPIPE_SOLUTIONS_WORK_STEALING_EXECUTOR_H_
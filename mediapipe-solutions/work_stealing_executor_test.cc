@@ -0,0 +1,164 @@
+// Copyright 2020 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe-solutions/work_stealing_executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace mediapipe_solutions {
+namespace {
+
+// Counts finished tasks and lets the test wait for them.
+class Completion {
+	public:
+		void Done() {
+			lock_guard<mutex> lock(mutex_);
+
+			++done_;
+			wake_.notify_all();
+		}
+
+		bool WaitFor(int count) {
+			unique_lock<mutex> lock(mutex_);
+
+			return wake_.wait_for(lock, seconds(10), [this, count]() { return done_ >= count; });
+		}
+	private:
+		mutex mutex_;
+		condition_variable wake_;
+		int done_ = 0;
+};
+
+TEST(WorkStealingExecutorTest, RunsEveryTask) {
+	constexpr int kTasks = 10000;
+	auto pool = WorkStealingExecutor::Create(4);
+	auto first = pool->CreateGraphExecutor("first");
+	auto second = pool->CreateGraphExecutor("second");
+	Completion completion;
+
+	EXPECT_EQ(pool->num_threads(), 4);
+
+	for (int i = 0; i < kTasks; ++i)
+		(i % 2 ? first : second)->Schedule([&completion]() { completion.Done(); });
+
+	ASSERT_TRUE(completion.WaitFor(kTasks));
+
+	// The statistics are updated before a task runs.
+	const auto stats = first->Stats();
+
+	EXPECT_EQ(stats.name, "first");
+	EXPECT_EQ(stats.tasks, uint64_t(kTasks / 2));
+	EXPECT_EQ(stats.queued, 0u);
+}
+
+TEST(WorkStealingExecutorTest, KeepsTheOrderOfAGraphOnOneWorker) {
+	auto pool = WorkStealingExecutor::Create(1);
+	auto graph = pool->CreateGraphExecutor("graph");
+	Completion completion;
+	vector<int> order;
+
+	for (int i = 0; i < 100; ++i)
+		graph->Schedule([&order, &completion, i]() { order.push_back(i); completion.Done(); });
+
+	ASSERT_TRUE(completion.WaitFor(100));
+
+	for (int i = 0; i < 100; ++i)
+		EXPECT_EQ(order[i], i);
+}
+
+TEST(WorkStealingExecutorTest, ServesGraphsRoundRobin) {
+	auto pool = WorkStealingExecutor::Create(1, /*quantum=*/2);
+	auto first = pool->CreateGraphExecutor("first");
+	auto second = pool->CreateGraphExecutor("second");
+	promise<void> started;
+	promise<void> release;
+	auto released = release.get_future().share();
+	Completion completion;
+	string order;
+
+	// Holds the only worker until both graphs have queued their tasks.
+	first->Schedule([&started, released]() { started.set_value(); released.wait(); });
+	started.get_future().wait();
+
+	for (int i = 0; i < 6; ++i)
+		first->Schedule([&order, &completion]() { order += 'a'; completion.Done(); });
+
+	for (int i = 0; i < 6; ++i)
+		second->Schedule([&order, &completion]() { order += 'b'; completion.Done(); });
+
+	release.set_value();
+	ASSERT_TRUE(completion.WaitFor(12));
+
+	EXPECT_EQ(order, "aabbaabbaabb");
+}
+
+TEST(WorkStealingExecutorTest, OtherWorkersRunTasksOfABlockedWorker) {
+	auto pool = WorkStealingExecutor::Create(2, /*quantum=*/8);
+	auto graph = pool->CreateGraphExecutor("graph");
+	promise<void> secondRan;
+	auto secondRanFuture = secondRan.get_future();
+	atomic<bool> unblocked { false };
+	Completion completion;
+
+	// The first task may take the second into its worker's deque; it only
+	// finishes in time if the other worker steals it.
+	graph->Schedule([&]() {
+		unblocked = secondRanFuture.wait_for(seconds(10)) == future_status::ready;
+		completion.Done();
+	});
+	graph->Schedule([&]() { secondRan.set_value(); completion.Done(); });
+
+	ASSERT_TRUE(completion.WaitFor(2));
+	EXPECT_TRUE(unblocked);
+}
+
+TEST(WorkStealingExecutorTest, ReportsStatsOfLiveGraphsOnly) {
+	auto pool = WorkStealingExecutor::Create(1);
+	auto kept = pool->CreateGraphExecutor("kept");
+	auto dropped = pool->CreateGraphExecutor("dropped");
+
+	dropped.reset();
+
+	const auto stats = pool->Stats();
+
+	ASSERT_EQ(stats.size(), 1u);
+	EXPECT_EQ(stats[0].name, "kept");
+}
+
+TEST(WorkStealingExecutorTest, DestructionRunsQueuedTasks) {
+	auto pool = WorkStealingExecutor::Create(2);
+	auto graph = pool->CreateGraphExecutor("graph");
+	atomic<int> ran { 0 };
+
+	for (int i = 0; i < 1000; ++i)
+		graph->Schedule([&ran]() { ++ran; });
+
+	pool.reset();
+
+	EXPECT_EQ(ran.load(), 1000);
+}
+
+}	// namespace
+}	// namespace mediapipe_solutions